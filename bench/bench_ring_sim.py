@@ -0,0 +1,279 @@
+"""
+Throughput benchmark for the ring simulator.
+
+Runs a grid of (N, M, D, X) scenarios on each selected backend and writes one
+JSON document with a record per cell: wall-clock per trial, simulated ticks,
+broadcasts sent and delivered per second, and the peak resident set size.
+Every cell runs in a fresh interpreter so that peak memory is per cell.
+
+    python3 bench/bench_ring_sim.py --grid readme,scaling --backend python,native
+    python3 bench/bench_ring_sim.py --grid stress --backend native --output bench.json
+    python3 bench/bench_ring_sim.py --compare old.json --output new.json
+
+Extra run_scenario keyword arguments are passed with --option key=value
+(e.g. --option movers=incremental --option event_driven=true).
+
+--profile-every K replays every native cell's trials with a phase profile
+sampling one loop iteration in K (see src/profiling.py) and adds the phase
+totals and their folded stacks to the record; --profile-dir also writes
+each cell's stacks to a .folded file for flamegraph.pl or speedscope. The
+timed trials are not profiled.
+
+    python3 bench/bench_ring_sim.py --grid scaling --backend native --profile-every 16 \
+        --profile-dir prof
+
+--shards 1,2,4,8 runs every cell once per thread count on the sharded
+schedule. Its arcs synchronize once per window of the least delay the
+links can draw, so uniform delays over [0, D] force a window of one tick;
+--option delay_floor=K draws delays uniformly from [K, D] instead.
+
+    python3 bench/bench_ring_sim.py --grid sharding --backend native --shards 1,2,4,8 \
+        --option delay_floor=8
+"""
+import argparse
+import json
+import os
+import platform
+import resource
+import subprocess
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.insert(0, os.path.join(ROOT, "src"))
+
+import delays  # noqa: E402
+import ring_native  # noqa: E402
+import ring_sim  # noqa: E402
+from profiling import Profile  # noqa: E402
+from rng import Pcg32  # noqa: E402
+
+# name -> [(N, M, D, X), ...]
+GRIDS = {
+    # The scenarios reported in the README
+    "readme": [(2000, m, 15, x) for m in (3, 4) for x in range(1, m + 1)],
+    "scaling": [
+        (100_000, 4, 15, 4),
+        (100_000, 16, 50, 8),
+        (100_000, 4, 500, 4),
+        (100_000, 64, 15, 3),
+        (1_000_000, 64, 15, 64),
+    ],
+    "stress": [(10_000_000, 128, 500, 128)],
+    # Large rings for --shards
+    "sharding": [(10_000_000, 256, 15, 256), (10_000_000, 1024, 15, 1024)],
+    # Few parties on a large ring against a crowded one, for comparing
+    # --option tracker=bitset with --option tracker=intervals
+    "density": [
+        (10_000_000, 2, 15, 1),
+        (10_000_000, 4, 15, 4),
+        (1_000_000, 256, 15, 256),
+    ],
+}
+DEFAULT_GRIDS = ("readme", "scaling")
+# Cells larger than this are skipped on the Python backend unless --all-python
+PYTHON_MAX_N = 100_000
+
+
+def _parse_value(text):
+    lowered = text.lower()
+    if lowered in ("true", "false"):
+        return lowered == "true"
+    try:
+        return int(text)
+    except ValueError:
+        return text
+
+
+def _peak_rss_kb():
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    return peak // 1024 if sys.platform == "darwin" else peak
+
+
+def _scenario_options(options, d):
+    """options as run_scenario takes them; delay_floor=K becomes a uniform model over [K, d]."""
+    options = dict(options)
+    floor = options.pop("delay_floor", None)
+    if floor is not None:
+        options["delay_model"] = delays.TableDelay.from_weights([0] * floor + [1] * (d + 1 - floor))
+    return options
+
+
+def run_cell(n, m, d, x, backend, trials, seed, options, profile_every=0):
+    """
+    Runs one cell in this process and returns its metrics record; with
+    profile_every, native cells also report a profile of their trials.
+    """
+    if backend == "native":
+        ring_native.load()
+    baseline_rss = _peak_rss_kb()
+    walls, wastes = [], []
+    totals = ring_sim.ScenarioStats()
+    scenario_options = _scenario_options(options, d)
+    for trial in range(trials):
+        rng = Pcg32(seed, stream=trial)
+        start = time.perf_counter()
+        waste, stats = ring_sim.run_scenario(n, m, d, x, backend=backend, rng=rng,
+                                             with_stats=True, **scenario_options)
+        walls.append(time.perf_counter() - start)
+        wastes.append(waste)
+        totals.ticks += stats.ticks
+        totals.iterations += stats.iterations
+        totals.broadcasts += stats.broadcasts
+        totals.delivered += stats.delivered
+        totals.network_s += stats.network_s
+        totals.moves_s += stats.moves_s
+    elapsed = sum(walls) or float("inf")
+    record = {
+        "n": n, "m": m, "d": d, "x": x, "backend": backend, "options": options,
+        "trials": trials, "seed": seed,
+        "wall_s_mean": elapsed / trials,
+        "wall_s_min": min(walls),
+        "wall_s_max": max(walls),
+        "ticks_per_trial": totals.ticks / trials,
+        "ticks_per_s": totals.ticks / elapsed,
+        "iterations_per_s": totals.iterations / elapsed,
+        "broadcasts_per_s": totals.broadcasts / elapsed,
+        "delivered_per_s": totals.delivered / elapsed,
+        "network_share": totals.network_s / elapsed,
+        "moves_share": totals.moves_s / elapsed,
+        "waste_mean": sum(wastes) / trials,
+        "peak_rss_kb": _peak_rss_kb(),
+        "baseline_rss_kb": baseline_rss,
+    }
+    if profile_every and backend == "native":
+        profile = Profile(every=profile_every)
+        for trial in range(trials):
+            ring_sim.run_scenario(n, m, d, x, backend=backend, rng=Pcg32(seed, stream=trial),
+                                  profile=profile, **scenario_options)
+        record["profile"] = profile.as_dict()
+        record["collapsed"] = profile.collapsed()
+    return record
+
+
+def _run_cell_subprocess(cell):
+    proc = subprocess.run(
+        [sys.executable, os.path.abspath(__file__), "--run-cell", json.dumps(cell)],
+        capture_output=True, text=True, check=False,
+    )
+    if proc.returncode != 0:
+        return dict(cell, error=proc.stderr.strip().splitlines()[-1:] or ["failed"])
+    return json.loads(proc.stdout)
+
+
+def _git_revision():
+    try:
+        return subprocess.run(["git", "rev-parse", "HEAD"], cwd=ROOT, capture_output=True,
+                              text=True, check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def _cell_key(record):
+    return (record["n"], record["m"], record["d"], record["x"], record["backend"],
+            json.dumps(record.get("options", {}), sort_keys=True))
+
+
+def compare(baseline, current, threshold):
+    """Prints the ticks/sec ratio per cell; returns the cells slower than threshold."""
+    old = {_cell_key(r): r for r in baseline["results"] if "error" not in r}
+    regressions = []
+    for record in current["results"]:
+        prev = old.get(_cell_key(record))
+        if prev is None or "error" in record:
+            continue
+        ratio = record["ticks_per_s"] / prev["ticks_per_s"]
+        label = "N={n} M={m} D={d} X={x} {backend}".format(**record)
+        print(f"{label:<40} {ratio:6.2f}x ticks/s", file=sys.stderr)
+        if ratio < threshold:
+            regressions.append(label)
+    return regressions
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--grid", default=",".join(DEFAULT_GRIDS),
+                        help=f"comma-separated grids from {sorted(GRIDS)}")
+    parser.add_argument("--backend", default="python,native", help="comma-separated backends")
+    parser.add_argument("--trials", type=int, default=5)
+    parser.add_argument("--seed", type=int, default=2024)
+    parser.add_argument("--option", action="append", default=[], metavar="KEY=VALUE",
+                        help="extra run_scenario keyword argument")
+    parser.add_argument("--all-python", action="store_true",
+                        help=f"also run Python cells with N > {PYTHON_MAX_N}")
+    parser.add_argument("--output", help="write the JSON document here instead of stdout")
+    parser.add_argument("--compare", help="baseline JSON document to compare ticks/sec against")
+    parser.add_argument("--fail-below", type=float, default=0.0,
+                        help="with --compare, exit non-zero if a cell drops below this ratio")
+    parser.add_argument("--shards", help="comma-separated thread counts for schedule=sharded")
+    parser.add_argument("--profile-every", type=int, default=0, metavar="K",
+                        help="profile native cells, sampling one loop iteration in K")
+    parser.add_argument("--profile-dir", help="with --profile-every, write <cell>.folded stacks here")
+    parser.add_argument("--run-cell", help=argparse.SUPPRESS)
+    args = parser.parse_args(argv)
+
+    if args.run_cell:
+        cell = json.loads(args.run_cell)
+        print(json.dumps(run_cell(**cell)))
+        return 0
+
+    options = dict(item.split("=", 1) for item in args.option)
+    options = {key: _parse_value(value) for key, value in options.items()}
+    backends = args.backend.split(",")
+    if "native" in backends and not ring_native.available():
+        print("native core not built; skipping native cells", file=sys.stderr)
+        backends.remove("native")
+
+    results = []
+    variants = [options]
+    if args.shards:
+        variants = [dict(options, schedule="sharded", shards=int(k)) for k in args.shards.split(",")]
+    for grid in args.grid.split(","):
+        for n, m, d, x in GRIDS[grid]:
+            for backend in backends:
+                if backend == "python" and n > PYTHON_MAX_N and not args.all_python:
+                    continue
+                for variant in variants:
+                    cell = dict(n=n, m=m, d=d, x=x, backend=backend, trials=args.trials,
+                                seed=args.seed, options=variant, profile_every=args.profile_every)
+                    record = dict(_run_cell_subprocess(cell), grid=grid)
+                    shards = f" shards={variant['shards']}" if "shards" in variant else ""
+                    if args.profile_dir and "collapsed" in record:
+                        os.makedirs(args.profile_dir, exist_ok=True)
+                        name = f"{grid}-N{n}-M{m}-D{d}-X{x}{shards.replace(' shards=', '-S')}.folded"
+                        with open(os.path.join(args.profile_dir, name), "w") as fh:
+                            fh.write("".join(line + "\n" for line in record["collapsed"]))
+                    print(f"{grid:<8} N={n:<9} M={m:<4} D={d:<4} X={x:<4} {backend:<7} "
+                          f"{record.get('wall_s_mean', float('nan')):.4f} s/trial{shards}",
+                          file=sys.stderr)
+                    results.append(record)
+
+    document = {
+        "meta": {
+            "revision": _git_revision(),
+            "python": platform.python_version(),
+            "platform": platform.platform(),
+            "cpu_count": os.cpu_count(),
+            "native_version": ring_native.load().ringsim_version().decode() if ring_native.available() else None,
+            "timestamp": time.strftime("%Y-%m-%dT%H:%M:%S%z"),
+        },
+        "results": results,
+    }
+    text = json.dumps(document, indent=2)
+    if args.output:
+        with open(args.output, "w") as fh:
+            fh.write(text + "\n")
+    else:
+        print(text)
+
+    if args.compare:
+        with open(args.compare) as fh:
+            regressions = compare(json.load(fh), document, args.fail_below)
+        if regressions:
+            print("regressions: " + ", ".join(regressions), file=sys.stderr)
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
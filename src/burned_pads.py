@@ -0,0 +1,186 @@
+"""
+Burned-pad trackers for run_scenario.
+
+A tracker records which pad indices of the n-pad ring have been used for
+encryption. Every tracker supports `in`, add() and len() like the set it
+replaces, plus next_unburned(start), the first fresh index at or after
+start in ring order (None when the ring is full). MappedBitset also takes
+touch(pointer, idx) whenever a party pointer moves, burning or not.
+"""
+import mmap
+import tempfile
+from bisect import bisect_right
+
+SET = "set"
+BITSET = "bitset"
+MMAP = "mmap"
+INTERVALS = "intervals"
+TRACKERS = (SET, BITSET, MMAP, INTERVALS)
+
+
+class BurnedSet(set):
+    """The original hash-set tracker, kept as the reference implementation."""
+    def __init__(self, n, iterable=()):
+        super().__init__(iterable)
+        self.n = n
+
+    def next_unburned(self, start):
+        for offset in range(self.n):
+            idx = (start + offset) % self.n
+            if idx not in self:
+                return idx
+        return None
+
+
+class BurnedBitset:
+    """
+    One bit per pad in a fixed bytearray, viewed as 64-bit words. The size
+    is maintained on insertion, so len() is O(1), and next_unburned() skips
+    fully burned words, costing O(L/64) for a burned run of length L.
+    """
+    def __init__(self, n, iterable=()):
+        self.n = n
+        self._nwords = (n + 63) // 64
+        self._buf = self._allocate(self._nwords * 8)
+        self._words = memoryview(self._buf).cast("Q")
+        self._count = 0
+        # Bits past the end of the ring read as burned so searches skip them
+        tail = self._nwords * 64 - n
+        if tail:
+            self._words[self._nwords - 1] = ((1 << tail) - 1) << (64 - tail)
+        for idx in iterable:
+            self.add(idx)
+
+    def __contains__(self, idx):
+        return (self._buf[idx >> 3] >> (idx & 7)) & 1 == 1
+
+    def __len__(self):
+        return self._count
+
+    def add(self, idx):
+        byte, bit = idx >> 3, 1 << (idx & 7)
+        if not self._buf[byte] & bit:
+            self._buf[byte] |= bit
+            self._count += 1
+
+    def next_unburned(self, start):
+        if self._count >= self.n:
+            return None
+        words, last = self._words, self._nwords - 1
+        w = start >> 6
+        # Mask off the bits below start in its word, then walk whole words
+        free = ~words[w] & (~0 << (start & 63)) & 0xFFFFFFFFFFFFFFFF
+        while not free:
+            w = 0 if w == last else w + 1
+            free = ~words[w] & 0xFFFFFFFFFFFFFFFF
+        # Count trailing zeros of the free mask
+        return (w << 6) + (free & -free).bit_length() - 1
+
+    def _allocate(self, nbytes):
+        return bytearray(nbytes)
+
+
+class MappedBitset(BurnedBitset):
+    """
+    BurnedBitset whose words live in a shared mapping of an unlinked
+    temporary file under TMPDIR, so a pool larger than RAM costs sparse disk
+    space and only the pages near the party pointers stay resident. Parties
+    walk the ring forward: the mapping is marked sequential, and touch()
+    asks for read-ahead whenever a pointer enters a new page. hints counts
+    those requests.
+    """
+    PAGE_PADS = mmap.PAGESIZE * 8
+    READ_AHEAD = 16 * mmap.PAGESIZE
+
+    def __init__(self, n, iterable=()):
+        self._pages = {}  # pointer -> page it was last seen in
+        self.hints = 0
+        super().__init__(n, iterable)
+
+    def _allocate(self, nbytes):
+        self._file = tempfile.TemporaryFile()
+        self._file.truncate(nbytes)
+        self._map = mmap.mmap(self._file.fileno(), nbytes)
+        self._advise = hasattr(self._map, "madvise")
+        if self._advise and hasattr(mmap, "MADV_SEQUENTIAL"):
+            self._map.madvise(mmap.MADV_SEQUENTIAL)
+        return self._map
+
+    def touch(self, pointer, idx):
+        """Pointer moved to idx; reads ahead of it if that is in a new page."""
+        page = idx // self.PAGE_PADS
+        if self._pages.get(pointer) == page:
+            return
+        self._pages[pointer] = page
+        self.hints += 1
+        start = (page + 1) * mmap.PAGESIZE
+        if self._advise and start < len(self._map):
+            self._map.madvise(mmap.MADV_WILLNEED, start, min(self.READ_AHEAD, len(self._map) - start))
+
+
+class BurnedIntervals:
+    """
+    Burned pads as sorted, disjoint half-open runs [start, end), coalesced
+    on insertion. Parties burn pads contiguously, so k, the number of runs,
+    stays near the number of party arcs: memory is O(k) regardless of n, and
+    membership and next_unburned() are O(log k) bisections.
+    """
+    def __init__(self, n, iterable=()):
+        self.n = n
+        self._starts = []
+        self._ends = []
+        self._count = 0
+        for idx in iterable:
+            self.add(idx)
+
+    def __contains__(self, idx):
+        i = bisect_right(self._starts, idx) - 1
+        return i >= 0 and idx < self._ends[i]
+
+    def __len__(self):
+        return self._count
+
+    def runs(self):
+        return list(zip(self._starts, self._ends))
+
+    def add(self, idx):
+        starts, ends = self._starts, self._ends
+        i = bisect_right(starts, idx)  # runs[i - 1] is the last one starting at or before idx
+        if i and idx < ends[i - 1]:
+            return
+        self._count += 1
+        joins_left = i and ends[i - 1] == idx
+        joins_right = i < len(starts) and starts[i] == idx + 1
+        if joins_left and joins_right:
+            ends[i - 1] = ends[i]
+            del starts[i], ends[i]
+        elif joins_left:
+            ends[i - 1] = idx + 1
+        elif joins_right:
+            starts[i] = idx
+        else:
+            starts.insert(i, idx)
+            ends.insert(i, idx + 1)
+
+    def _free_from(self, start):
+        # Runs are coalesced, so the end of a covering run is free (or n)
+        i = bisect_right(self._starts, start) - 1
+        return self._ends[i] if i >= 0 and start < self._ends[i] else start
+
+    def next_unburned(self, start):
+        if self._count >= self.n:
+            return None
+        idx = self._free_from(start)
+        return idx if idx < self.n else self._free_from(0)
+
+
+def make_burned(kind, n, iterable=()):
+    if kind == SET:
+        return BurnedSet(n, iterable)
+    if kind == BITSET:
+        return BurnedBitset(n, iterable)
+    if kind == MMAP:
+        return MappedBitset(n, iterable)
+    if kind == INTERVALS:
+        return BurnedIntervals(n, iterable)
+    raise ValueError(f"unknown burned-pad tracker {kind!r}, expected one of {TRACKERS}")
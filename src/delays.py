@@ -0,0 +1,210 @@
+"""
+Delivery delay models for AsynchronousNetwork.
+
+A model draws the delay, in ticks, of each position update a sender
+broadcasts: draw(rng, sender_id) returns an integer in [0, max_delay], and
+max_delay sizes the network's timing wheel. reset() is called by every new
+network, so a stateful model (a replayed trace) starts over in each run.
+
+UniformDelay is the original model and draws with rng.randint. The other
+parametric models are discrete distributions kept as a CDF table of 32-bit
+thresholds (TableDelay): one getrandbits(32) draw and a binary search per
+update, in integer arithmetic only, so the native core draws the same
+delays from the same Pcg32 state. TraceDelay replays recorded latencies
+from a trace file (see write_trace) and draws nothing from rng.
+"""
+import math
+import struct
+import sys
+from array import array
+from bisect import bisect_right
+
+TRACE_MAGIC = b"RINGDLY1"
+# magic, record count, largest delay, reserved; uint16 delays follow
+TRACE_HEADER = struct.Struct("<8sQII")
+TRACE_CHUNK = 65_536  # records read per refill
+_ONE = 1 << 32
+
+
+class UniformDelay:
+    """Delays drawn uniformly from [0, max_delay]."""
+    def __init__(self, max_delay):
+        if max_delay < 0:
+            raise ValueError(f"max_delay must be non-negative, got {max_delay}")
+        self.max_delay = max_delay
+
+    def reset(self):
+        pass
+
+    def draw(self, rng, sender_id):
+        return rng.randint(0, self.max_delay)
+
+    @property
+    def cdf(self):
+        return _thresholds([1.0] * (self.max_delay + 1))
+
+
+class TableDelay:
+    """
+    A discrete delay distribution over [0, max_delay], given by its
+    thresholds: cdf[k] is P(delay <= k) scaled to 2**32, for k < max_delay.
+    A draw is the number of thresholds at or below a uniform 32-bit word.
+    """
+    def __init__(self, cdf):
+        if any(b < a for a, b in zip(cdf, cdf[1:])) or any(not 0 <= t <= _ONE for t in cdf):
+            raise ValueError("delay thresholds must be ascending within [0, 2**32]")
+        self.cdf = list(cdf)
+        self.max_delay = len(self.cdf)
+
+    @classmethod
+    def from_weights(cls, weights):
+        """The distribution with P(delay = k) proportional to weights[k]."""
+        return cls(_thresholds(weights))
+
+    def reset(self):
+        pass
+
+    def draw(self, rng, sender_id):
+        return bisect_right(self.cdf, rng.getrandbits(32))
+
+
+class GeometricDelay(TableDelay):
+    """
+    P(delay = k) = (1 - p)^k * p, the delay of a link that gets each tick's
+    transmission through with probability p. The tail beyond max_delay is
+    delivered at max_delay.
+    """
+    def __init__(self, p, max_delay):
+        if not 0 < p <= 1:
+            raise ValueError(f"p must be in (0, 1], got {p}")
+        survival = [(1 - p) ** k for k in range(max_delay + 1)]
+        super().__init__(_thresholds(_masses(survival)))
+        self.p = p
+
+
+class ParetoDelay(TableDelay):
+    """
+    Heavy-tailed delays: P(delay >= k) = (1 + k / scale)^-alpha (a Lomax, or
+    Pareto II, law on the integers). The tail beyond max_delay is delivered
+    at max_delay, so long stalls pile up at the bound as timeouts would.
+    """
+    def __init__(self, alpha, max_delay, scale=1.0):
+        if alpha <= 0 or scale <= 0:
+            raise ValueError("alpha and scale must be positive")
+        survival = [(1 + k / scale) ** -alpha for k in range(max_delay + 1)]
+        super().__init__(_thresholds(_masses(survival)))
+        self.alpha, self.scale = alpha, scale
+
+
+class LinkDelay:
+    """
+    Per-link delays: links[s - 1][r - 1] is the model (TableDelay or
+    UniformDelay) of the link from sender s to receiver r, for an m x m
+    matrix. An update is drawn on the link to the sender's ring predecessor,
+    the one party whose move rule reads the sender's position; the other
+    parties' views are written at the same tick, which cannot change a run
+    (see propagation='neighbor'). Every link draws through its CDF table.
+    """
+    def __init__(self, links):
+        m = len(links)
+        if m < 1 or any(len(row) != m for row in links):
+            raise ValueError("links must be a square matrix of delay models")
+        self.m = m
+        width = max(links[s][(s - 1) % m].max_delay for s in range(m))
+        # Pad every row to a common width: the extra thresholds never trigger
+        self.rows = []
+        for s in range(m):
+            cdf = links[s][(s - 1) % m].cdf
+            self.rows.append(cdf + [_ONE] * (width - len(cdf)))
+        self.max_delay = width
+
+    def reset(self):
+        pass
+
+    def draw(self, rng, sender_id):
+        return bisect_right(self.rows[sender_id - 1], rng.getrandbits(32))
+
+
+class TraceDelay:
+    """
+    Replays the delays recorded in a trace file, one record per update in
+    send order, streaming TRACE_CHUNK records at a time so the file is never
+    held in memory. Past the last record the trace starts over.
+
+    A trace file is TRACE_HEADER (magic, record count, largest delay) and
+    then the delays as little-endian uint16 ticks; write_trace() makes one.
+    """
+    def __init__(self, path, chunk=TRACE_CHUNK):
+        self.path, self.chunk = path, chunk
+        with open(path, "rb") as stream:
+            raw = stream.read(TRACE_HEADER.size)
+        if len(raw) < TRACE_HEADER.size:
+            raise ValueError(f"not a delay trace: {path}")
+        magic, self.count, self.max_delay, _ = TRACE_HEADER.unpack(raw)
+        if magic != TRACE_MAGIC or self.count == 0:
+            raise ValueError(f"not a delay trace, or an empty one: {path}")
+        self._stream = None
+        self._buf = array("H")
+        self._read = self._next = 0
+
+    def reset(self):
+        if self._stream is None:
+            self._stream = open(self.path, "rb")
+        self._stream.seek(TRACE_HEADER.size)
+        self._read = 0
+        self._buf = array("H")
+        self._next = 0
+
+    def _refill(self):
+        if self._read == self.count:
+            self._stream.seek(TRACE_HEADER.size)
+            self._read = 0
+        records = min(self.chunk, self.count - self._read)
+        self._buf = array("H", self._stream.read(2 * records))
+        if len(self._buf) != records:
+            raise ValueError(f"truncated delay trace: {self.path}")
+        if sys.byteorder == "big":
+            self._buf.byteswap()
+        self._read += records
+        self._next = 0
+
+    def draw(self, rng, sender_id):
+        if self._next == len(self._buf):
+            self._refill()
+        self._next += 1
+        return min(self._buf[self._next - 1], self.max_delay)
+
+    def close(self):
+        if self._stream is not None:
+            self._stream.close()
+            self._stream = None
+
+
+def write_trace(path, delays):
+    """Writes the delays (ticks, each in [0, 65535]) as a trace file."""
+    records = array("H", delays)
+    largest = max(records, default=0)
+    if sys.byteorder == "big":
+        records.byteswap()
+    with open(path, "wb") as stream:
+        stream.write(TRACE_HEADER.pack(TRACE_MAGIC, len(records), largest, 0))
+        records.tofile(stream)
+    return path
+
+
+def _masses(survival):
+    """P(delay = k) for k < len(survival) - 1, the remaining tail at the end."""
+    masses = [a - b for a, b in zip(survival, survival[1:])]
+    masses.append(survival[-1])
+    return masses
+
+
+def _thresholds(weights):
+    total = math.fsum(weights)
+    if total <= 0 or any(w < 0 for w in weights):
+        raise ValueError("delay weights must be non-negative with a positive sum")
+    cdf, running = [], 0.0
+    for weight in weights[:-1]:
+        running += weight
+        cdf.append(min(_ONE, round(running / total * _ONE)))
+    return cdf
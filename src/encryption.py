@@ -0,0 +1,155 @@
+"""
+Batched one-time-pad encryption for the 'data' move path.
+
+run_scenario only tracks which pad indices are burned; EncryptionStage
+spends them on real payloads. A party's queued messages are encrypted
+together: the stage reserves a contiguous run of fresh pads after the
+party's position, under the same rules a run of Data moves obeys, XORs the
+whole batch against that run of a memory-mapped pad file in one pass, burns
+the run and broadcasts the party's final position once.
+
+The XOR runs in the native core's SIMD kernel (ring_native.xor_kernel()
+names it) on the native backend, and as a big-integer XOR otherwise.
+"""
+import mmap
+import os
+import time
+
+try:
+    from . import ring_native
+except ImportError:
+    import ring_native
+
+
+class PadFile:
+    """
+    n pads of pad_size bytes each, memory-mapped from path: pad i is the
+    bytes [i * pad_size, (i + 1) * pad_size). The map is copy-on-write, so
+    nothing is ever written back to the file.
+    """
+    def __init__(self, path, n, pad_size, backend=None):
+        self.n, self.pad_size = n, pad_size
+        self.backend = backend or os.environ.get("RING_SIM_BACKEND", "python")
+        with open(path, "rb") as stream:
+            if os.fstat(stream.fileno()).st_size < n * pad_size:
+                raise ValueError(f"pad file {path} holds fewer than {n} pads of {pad_size} bytes")
+            self._map = mmap.mmap(stream.fileno(), n * pad_size, access=mmap.ACCESS_COPY)
+
+    def xor(self, buf, first):
+        """
+        XORs buf in place with the bytes from the start of pad `first` on,
+        continuing at pad 0 past the end of the ring.
+        """
+        start, total = first * self.pad_size, len(self._map)
+        head = min(len(buf), total - start)
+        self._xor(memoryview(buf)[:head], start)
+        if head < len(buf):
+            self._xor(memoryview(buf)[head:], 0)
+
+    def _xor(self, view, offset):
+        if self.backend == "native":
+            ring_native.xor_pads(view, self._map, offset)
+            return
+        pad = self._map[offset:offset + len(view)]
+        mixed = int.from_bytes(view, "little") ^ int.from_bytes(pad, "little")
+        view[:] = mixed.to_bytes(len(view), "little")
+
+    def decrypt(self, index, ciphertext):
+        buf = bytearray(ciphertext)
+        self.xor(buf, index)
+        return bytes(buf)
+
+    def close(self):
+        self._map.close()
+
+
+class EncryptionStage:
+    """
+    Queues messages per party and encrypts them in batches, one message per
+    pad. flush(party) reserves the longest run of pads after the party's
+    position that a run of Data moves could take: every pad fresh in
+    burned, and each step leaving at least d pads before the party's view
+    of its front neighbour. Messages that do not fit stay queued for the
+    next flush.
+    """
+    def __init__(self, pads, burned, network, d):
+        self.pads, self.burned, self.network, self.d = pads, burned, network, d
+        self._queues = {}
+
+    def submit(self, party, message):
+        if len(message) > self.pads.pad_size:
+            raise ValueError(f"message of {len(message)} bytes exceeds the pad size")
+        self._queues.setdefault(party.party_id, []).append(message)
+
+    def pending(self, party):
+        return len(self._queues.get(party.party_id, ()))
+
+    def reserve(self, party, count):
+        """First pad and length of the run party may burn for up to count messages."""
+        n = self.pads.n
+        pos = party.my_index
+        front = party.view_of_others[party.party_id % party.m + 1]
+        # The k-th step needs a gap of more than d before it is taken
+        limit = min(count, (front - pos) % n - self.d)
+        length = 0
+        while length < limit and (pos + 1 + length) % n not in self.burned:
+            length += 1
+        return (pos + 1) % n, length
+
+    def flush(self, party):
+        """
+        Encrypts as many queued messages of party as the reserved run allows;
+        returns their [(pad index, ciphertext)] in queue order.
+        """
+        queue = self._queues.get(party.party_id)
+        if not queue:
+            return []
+        first, length = self.reserve(party, len(queue))
+        if length == 0:
+            return []
+        n, size = self.pads.n, self.pads.pad_size
+        for idx in ((first + k) % n for k in range(length)):
+            if idx in self.burned:
+                raise RuntimeError(f"CRITICAL SECURITY FAILURE: Pad index {idx} reused!")
+            self.burned.add(idx)
+
+        batch = queue[:length]
+        del queue[:length]
+        buf = bytearray(length * size)
+        for k, message in enumerate(batch):
+            buf[k * size:k * size + len(message)] = message
+        self.pads.xor(buf, first)
+
+        last = (first + length - 1) % n
+        party.my_index = last
+        party.pads_used += length
+        self.network.send_broadcast(party.party_id, last)
+        view = memoryview(buf)
+        return [((first + k) % n, bytes(view[k * size:k * size + len(message)]))
+                for k, message in enumerate(batch)]
+
+
+def throughput(path, n, pad_size, backend=None, repeat=5):
+    """Bytes per second XORed against the whole pad file, best of repeat runs."""
+    pads = PadFile(path, n, pad_size, backend=backend)
+    buf = bytearray(n * pad_size)
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        pads.xor(buf, 0)
+        best = min(best, time.perf_counter() - start)
+    pads.close()
+    return len(buf) / best
+
+
+if __name__ == "__main__":
+    import tempfile
+
+    n, pad_size = 16_384, 4096
+    with tempfile.NamedTemporaryFile() as stream:
+        stream.write(os.urandom(n * pad_size))
+        stream.flush()
+        for backend in ("python", "native") if ring_native.available() else ("python",):
+            rate = throughput(stream.name, n, pad_size, backend=backend)
+            kernel = f" ({ring_native.xor_kernel()})" if backend == "native" else ""
+            print(f"{backend}{kernel}: {rate / 1e9:.2f} GB/s over {n * pad_size >> 20} MiB")
@@ -0,0 +1,76 @@
+#include "burned_pads.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace ringsim {
+
+namespace {
+
+constexpr size_t kPageBytes = BitsetWords::kPadsPerPage / 8;
+// Pages read ahead of a pointer each time it enters a new page
+constexpr size_t kReadAheadPages = 16;
+
+// Creates and unlinks a sparse temporary file of the given size; returns its descriptor.
+int temporary_file(size_t bytes) {
+    const char* dir = std::getenv("TMPDIR");
+    std::string path = std::string(dir != nullptr && *dir ? dir : "/tmp") + "/ringsim-burned-XXXXXX";
+    const int fd = ::mkstemp(&path[0]);
+    if (fd < 0) {
+        throw std::bad_alloc();
+    }
+    ::unlink(path.c_str());
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        ::close(fd);
+        throw std::bad_alloc();
+    }
+    return fd;
+}
+
+}  // namespace
+
+BitsetWords::BitsetWords(size_t count, bool mapped) : size_(count), mapped_(mapped) {
+    if (!mapped) {
+        data_ = static_cast<uint64_t*>(std::calloc(count, sizeof(uint64_t)));
+        if (data_ == nullptr) {
+            throw std::bad_alloc();
+        }
+        return;
+    }
+    bytes_ = (count * sizeof(uint64_t) + kPageBytes - 1) / kPageBytes * kPageBytes;
+    const int fd = temporary_file(bytes_);
+    void* addr = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // The mapping keeps the file alive once the descriptor is gone
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    // Parties walk the ring forward, so favour read-ahead and early reclaim
+    ::madvise(addr, bytes_, MADV_SEQUENTIAL);
+    data_ = static_cast<uint64_t*>(addr);
+}
+
+BitsetWords::~BitsetWords() {
+    if (mapped_) {
+        ::munmap(data_, bytes_);
+    } else {
+        std::free(data_);
+    }
+}
+
+void BitsetWords::advance(size_t w) const {
+    static const size_t system_page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t start = (w * sizeof(uint64_t) / kPageBytes + 1) * kPageBytes;
+    start -= start % system_page;
+    if (start < bytes_) {
+        char* base = reinterpret_cast<char*>(data_);
+        ::madvise(base + start, std::min(kReadAheadPages * kPageBytes, bytes_ - start), MADV_WILLNEED);
+    }
+}
+
+}  // namespace ringsim
@@ -0,0 +1,223 @@
+// Burned-pad trackers for the native core (see src/burned_pads.py).
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace ringsim {
+
+// Zeroed word storage for BurnedBitset. The mapped variant lives in a shared
+// mapping of an unlinked temporary file under $TMPDIR: a ring of 10^11 pads
+// then costs sparse disk space instead of RAM, and only the pages around the
+// party pointers stay resident.
+class BitsetWords {
+public:
+    // Pads covered by one 4 KiB page of words; touch() hints at each boundary.
+    static constexpr int64_t kPadsPerPage = 4096 * 8;
+
+    BitsetWords(size_t count, bool mapped);
+    ~BitsetWords();
+    BitsetWords(const BitsetWords&) = delete;
+    BitsetWords& operator=(const BitsetWords&) = delete;
+
+    uint64_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool mapped() const { return mapped_; }
+    // Sequential hint: asks the kernel to read ahead the pages after word w.
+    void advance(size_t w) const;
+
+private:
+    uint64_t* data_ = nullptr;
+    size_t size_;
+    size_t bytes_ = 0;  // length of the mapping
+    bool mapped_;
+};
+
+// One bit per pad with a maintained population count. Bits past the end of
+// the ring are preset so that searches skip them without a bounds check.
+class BurnedBitset {
+public:
+    explicit BurnedBitset(int64_t n, bool mapped = false)
+        : n_(n), words_(static_cast<size_t>((n + 63) / 64), mapped) {
+        const int64_t tail = static_cast<int64_t>(words_.size()) * 64 - n;
+        if (tail) {
+            words_.data()[words_.size() - 1] = ~0ULL << (64 - tail);
+        }
+    }
+
+    bool contains(int64_t idx) const { return (words_.data()[idx >> 6] >> (idx & 63)) & 1; }
+
+    // Returns false if the pad was already burned.
+    bool add(int64_t idx) {
+        uint64_t& word = words_.data()[idx >> 6];
+        const uint64_t bit = 1ULL << (idx & 63);
+        if (word & bit) {
+            return false;
+        }
+        word |= bit;
+        count_ += 1;
+        return true;
+    }
+
+    // A party pointer moved to idx, burning it or not. On a mapped bitset,
+    // reads ahead of the pointer whenever it enters a new page.
+    void touch(int64_t pointer, int64_t idx) {
+        if (!words_.mapped()) {
+            return;
+        }
+        const int64_t page = idx / BitsetWords::kPadsPerPage;
+        if (static_cast<size_t>(pointer) >= pages_.size()) {
+            pages_.resize(static_cast<size_t>(pointer) + 1, -1);
+        }
+        if (pages_[pointer] != page) {
+            pages_[pointer] = page;
+            words_.advance(static_cast<size_t>(idx >> 6));
+        }
+    }
+
+    int64_t size() const { return count_; }
+
+    // Raw word storage, for checkpoints; call recount() after writing to it.
+    uint64_t* words() { return words_.data(); }
+    const uint64_t* words() const { return words_.data(); }
+    size_t word_count() const { return words_.size(); }
+    void recount() {
+        int64_t bits = 0;
+        for (size_t w = 0; w < words_.size(); ++w) {
+            bits += __builtin_popcountll(words_.data()[w]);
+        }
+        count_ = bits - (static_cast<int64_t>(words_.size()) * 64 - n_);
+    }
+
+    // First unburned index at or after start in ring order, or -1 when full.
+    int64_t next_unburned(int64_t start) const {
+        if (count_ >= n_) {
+            return -1;
+        }
+        const uint64_t* words = words_.data();
+        const size_t last = words_.size() - 1;
+        size_t w = static_cast<size_t>(start >> 6);
+        uint64_t free = ~words[w] & (~0ULL << (start & 63));
+        while (!free) {
+            w = w == last ? 0 : w + 1;
+            free = ~words[w];
+        }
+        return static_cast<int64_t>(w << 6) + __builtin_ctzll(free);
+    }
+
+private:
+    int64_t n_;
+    int64_t count_ = 0;
+    BitsetWords words_;
+    std::vector<int64_t> pages_;  // page each pointer was last touched in
+};
+
+// Sorted, disjoint half-open runs [start, end) keyed by start and coalesced
+// on insertion: O(k) memory and O(log k) queries for k runs, which stays
+// near the number of party arcs however large the ring is.
+class BurnedIntervals {
+public:
+    explicit BurnedIntervals(int64_t n) : n_(n) {}
+
+    bool contains(int64_t idx) const {
+        auto it = runs_.upper_bound(idx);
+        return it != runs_.begin() && idx < std::prev(it)->second;
+    }
+
+    // Returns false if the pad was already burned.
+    bool add(int64_t idx) {
+        auto next = runs_.upper_bound(idx);
+        const bool joins_right = next != runs_.end() && next->first == idx + 1;
+        if (next != runs_.begin()) {
+            auto prev = std::prev(next);
+            if (idx < prev->second) {
+                return false;
+            }
+            if (prev->second == idx) {
+                prev->second = joins_right ? next->second : idx + 1;
+                if (joins_right) {
+                    runs_.erase(next);
+                }
+                count_ += 1;
+                return true;
+            }
+        }
+        if (joins_right) {
+            // Re-key the node in place instead of reallocating it
+            auto node = runs_.extract(next);
+            node.key() = idx;
+            runs_.insert(std::move(node));
+        } else {
+            runs_.emplace_hint(next, idx, idx + 1);
+        }
+        count_ += 1;
+        return true;
+    }
+
+    int64_t size() const { return count_; }
+    size_t run_count() const { return runs_.size(); }
+
+    // First unburned index at or after start in ring order, or -1 when full.
+    int64_t next_unburned(int64_t start) const {
+        if (count_ >= n_) {
+            return -1;
+        }
+        const int64_t idx = free_from(start);
+        return idx < n_ ? idx : free_from(0);
+    }
+
+private:
+    // Runs are coalesced, so the end of a covering run is free (or n)
+    int64_t free_from(int64_t start) const {
+        auto it = runs_.upper_bound(start);
+        if (it == runs_.begin()) {
+            return start;
+        }
+        --it;
+        return start < it->second ? it->second : start;
+    }
+
+    int64_t n_;
+    int64_t count_ = 0;
+    std::map<int64_t, int64_t> runs_;
+};
+
+// The tracker a Scenario burns pads in: a BurnedBitset, in RAM or mapped,
+// or BurnedIntervals. The choice is fixed per run, so the dispatch branch
+// is perfectly predicted.
+class BurnedPads {
+public:
+    BurnedPads(int64_t n, bool intervals, bool mapped) {
+        if (intervals) {
+            runs_.emplace(n);
+        } else {
+            bits_.emplace(n, mapped);
+        }
+    }
+
+    bool contains(int64_t idx) const { return bits_ ? bits_->contains(idx) : runs_->contains(idx); }
+    bool add(int64_t idx) { return bits_ ? bits_->add(idx) : runs_->add(idx); }
+    void touch(int64_t pointer, int64_t idx) {
+        if (bits_) {
+            bits_->touch(pointer, idx);
+        }
+    }
+    int64_t size() const { return bits_ ? bits_->size() : runs_->size(); }
+    int64_t next_unburned(int64_t start) const {
+        return bits_ ? bits_->next_unburned(start) : runs_->next_unburned(start);
+    }
+
+    // The bitset for raw word access (checkpoints), or nullptr for intervals.
+    BurnedBitset* bitset() { return bits_ ? &*bits_ : nullptr; }
+    const BurnedBitset* bitset() const { return bits_ ? &*bits_ : nullptr; }
+
+private:
+    std::optional<BurnedBitset> bits_;
+    std::optional<BurnedIntervals> runs_;
+};
+
+}  // namespace ringsim
@@ -0,0 +1,279 @@
+#include "checkpoint.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "ring_core.hpp"
+
+namespace ringsim {
+
+namespace {
+
+std::string describe(const std::string& what, const std::string& path) {
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+uint64_t checkpoint_flags(const Config& cfg) {
+    return (cfg.coalesce ? 1u : 0u) | (cfg.skip_drift ? 2u : 0u) | (cfg.incremental ? 4u : 0u) |
+           (cfg.event_driven ? 8u : 0u) | (cfg.neighbor_only ? 16u : 0u) | (cfg.batch ? 32u : 0u);
+}
+
+// Snapshots store the raw bitset words; interval trackers have none. Nor
+// do they hold delay estimators, trace positions or delays other than the
+// uniform [0, d].
+template <typename Pads>
+auto& checkpointable(const Config& cfg, Pads& burned) {
+    if (burned.bitset() == nullptr) {
+        throw CheckpointError("checkpoints need a bitset burned-pad tracker");
+    }
+    const bool uniform = cfg.delay_trace.empty() && cfg.delay_cdf_width < 0;
+    if (cfg.adaptive || !uniform || (cfg.link_delay >= 0 && cfg.link_delay != cfg.d)) {
+        throw CheckpointError("checkpoints need adaptive=False and uniform delays over [0, d]");
+    }
+    if (cfg.traffic) {
+        throw CheckpointError("traffic runs cannot be checkpointed");
+    }
+    return *burned.bitset();
+}
+
+void put_ids(CheckpointWriter& out, const std::vector<int64_t>& ids) {
+    out.put(static_cast<int64_t>(ids.size()));
+    out.write(ids.data(), ids.size() * sizeof(int64_t));
+}
+
+std::vector<int64_t> get_ids(CheckpointReader& in, int64_t limit) {
+    const int64_t count = in.get();
+    if (count < 0 || count > limit) {
+        throw CheckpointError("corrupt checkpoint: bad list length");
+    }
+    std::vector<int64_t> ids(static_cast<size_t>(count));
+    in.read(ids.data(), ids.size() * sizeof(int64_t));
+    return ids;
+}
+
+void check_ids(const std::vector<int64_t>& ids, int64_t m) {
+    for (int64_t pid : ids) {
+        if (pid < 1 || pid > m) {
+            throw CheckpointError("corrupt checkpoint: bad party id");
+        }
+    }
+}
+
+}  // namespace
+
+CheckpointWriter::CheckpointWriter(const std::string& path) : file_(std::fopen(path.c_str(), "wb")) {
+    if (file_ == nullptr) {
+        throw CheckpointError(describe("cannot create checkpoint", path));
+    }
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    if (file_ != nullptr) {
+        std::fclose(file_);
+    }
+}
+
+void CheckpointWriter::write(const void* data, size_t bytes) {
+    if (bytes > 0 && std::fwrite(data, 1, bytes, file_) != bytes) {
+        throw CheckpointError("checkpoint write failed");
+    }
+    offset_ += bytes;
+}
+
+void CheckpointWriter::pad_to(uint64_t offset) {
+    static const char zeros[kCheckpointAlign] = {};
+    while (offset_ < offset) {
+        write(zeros, static_cast<size_t>(std::min<uint64_t>(offset - offset_, sizeof zeros)));
+    }
+}
+
+void CheckpointWriter::close() {
+    std::FILE* file = file_;
+    file_ = nullptr;
+    if (std::fflush(file) != 0 || std::fclose(file) != 0) {
+        throw CheckpointError("checkpoint write failed");
+    }
+}
+
+CheckpointReader::CheckpointReader(const std::string& path) : file_(std::fopen(path.c_str(), "rb")) {
+    if (file_ == nullptr) {
+        throw CheckpointError(describe("cannot open checkpoint", path));
+    }
+}
+
+CheckpointReader::~CheckpointReader() { std::fclose(file_); }
+
+void CheckpointReader::read(void* data, size_t bytes) {
+    if (bytes > 0 && std::fread(data, 1, bytes, file_) != bytes) {
+        throw CheckpointError("truncated checkpoint");
+    }
+}
+
+void CheckpointReader::seek(uint64_t offset) {
+    if (std::fseek(file_, static_cast<long>(offset), SEEK_SET) != 0) {
+        throw CheckpointError("truncated checkpoint");
+    }
+}
+
+void AsynchronousNetwork::save(CheckpointWriter& out) const {
+    for (int64_t value :
+         {current_time, pending_, sent_, delivered_, superseded_, view_updates_, max_pending_}) {
+        out.put(value);
+    }
+    for (const std::vector<Message>& slot : wheel_) {
+        out.put(static_cast<int64_t>(slot.size()));
+        out.write(slot.data(), slot.size() * sizeof(Message));
+    }
+    for (const std::deque<int64_t>& inflight : inflight_) {
+        out.put(static_cast<int64_t>(inflight.size()));
+        for (int64_t due : inflight) {
+            out.put(due);
+        }
+    }
+}
+
+void AsynchronousNetwork::load(CheckpointReader& in, int64_t m) {
+    for (int64_t* value :
+         {&current_time, &pending_, &sent_, &delivered_, &superseded_, &view_updates_, &max_pending_}) {
+        *value = in.get();
+    }
+    int64_t queued = 0;
+    for (std::vector<Message>& slot : wheel_) {
+        const int64_t count = in.get();
+        if (count < 0 || count > pending_) {
+            throw CheckpointError("corrupt checkpoint: bad network queue");
+        }
+        slot.resize(static_cast<size_t>(count));
+        in.read(slot.data(), slot.size() * sizeof(Message));
+        for (const Message& msg : slot) {
+            if (msg.sender_id < 1 || msg.sender_id > m) {
+                throw CheckpointError("corrupt checkpoint: bad network queue");
+            }
+        }
+        queued += count;
+    }
+    if (queued != pending_) {
+        throw CheckpointError("corrupt checkpoint: bad network queue");
+    }
+    for (std::deque<int64_t>& inflight : inflight_) {
+        const int64_t count = in.get();
+        if (count < 0 || count > pending_) {
+            throw CheckpointError("corrupt checkpoint: bad network queue");
+        }
+        inflight.clear();
+        for (int64_t i = 0; i < count; ++i) {
+            inflight.push_back(in.get());
+        }
+    }
+}
+
+void Scenario::save(const std::string& path) const {
+    const BurnedBitset& burned = checkpointable(cfg_, burned_);
+    CheckpointHeader header{};
+    std::memcpy(header.magic, kCheckpointMagic, sizeof header.magic);
+    header.version = kCheckpointVersion;
+    header.n = cfg_.n;
+    header.m = cfg_.m;
+    header.d = cfg_.d;
+    header.x = cfg_.x;
+    header.flags = checkpoint_flags(cfg_);
+    header.rng_state = rng_.state;
+    header.rng_inc = rng_.inc;
+    header.iterations = iterations_;
+    std::copy(std::begin(move_counts_), std::end(move_counts_), header.move_counts);
+    header.status_evaluations = status_evaluations_;
+    header.burned_count = burned.size();
+    header.bitset_offset = (sizeof header + kCheckpointAlign - 1) / kCheckpointAlign * kCheckpointAlign;
+    header.bitset_words = burned.word_count();
+
+    const std::string partial = path + ".tmp";
+    CheckpointWriter out(partial);
+    out.write(&header, sizeof header);
+    out.pad_to(header.bitset_offset);
+    out.write(burned.words(), burned.word_count() * sizeof(uint64_t));
+    put_ids(out, active_ids_);
+    out.write(parties_.views.data(), parties_.views.size() * sizeof(int64_t));
+    out.write(parties_.my_index.data(), parties_.my_index.size() * sizeof(int64_t));
+    out.write(parties_.pads_used.data(), parties_.pads_used.size() * sizeof(int64_t));
+    put_ids(out, legal_active_.ids);
+    put_ids(out, legal_silent_.ids);
+    network_.save(out);
+    out.close();
+    if (std::rename(partial.c_str(), path.c_str()) != 0) {
+        throw CheckpointError(describe("cannot replace checkpoint", path));
+    }
+}
+
+void Scenario::restore(const std::string& path) {
+    BurnedBitset& burned = checkpointable(cfg_, burned_);
+    CheckpointReader in(path);
+    CheckpointHeader header;
+    in.read(&header, sizeof header);
+    if (std::memcmp(header.magic, kCheckpointMagic, sizeof header.magic) != 0 ||
+        header.version != kCheckpointVersion) {
+        throw CheckpointError("not a ring_sim checkpoint: " + path);
+    }
+    if (header.n != cfg_.n || header.m != cfg_.m || header.d != cfg_.d || header.x != cfg_.x ||
+        header.flags != checkpoint_flags(cfg_) || header.bitset_words != burned.word_count()) {
+        throw CheckpointError("checkpoint " + path + " was written for a different configuration");
+    }
+    const int64_t m = cfg_.m;
+
+    in.seek(header.bitset_offset);
+    in.read(burned.words(), burned.word_count() * sizeof(uint64_t));
+    burned.recount();
+    if (burned.size() != header.burned_count) {
+        throw CheckpointError("corrupt checkpoint: burned pad count mismatch");
+    }
+
+    active_ids_ = get_ids(in, m);
+    check_ids(active_ids_, m);
+    if (static_cast<int64_t>(active_ids_.size()) != cfg_.x) {
+        throw CheckpointError("corrupt checkpoint: bad active set");
+    }
+    std::fill(is_active_.begin(), is_active_.end(), 0);
+    for (int64_t pid : active_ids_) {
+        is_active_[pid] = 1;
+    }
+    silent_ids_.clear();
+    for (int64_t pid : all_ids_) {
+        if (!is_active_[pid]) {
+            silent_ids_.push_back(pid);
+        }
+    }
+
+    in.read(parties_.views.data(), parties_.views.size() * sizeof(int64_t));
+    in.read(parties_.my_index.data(), parties_.my_index.size() * sizeof(int64_t));
+    in.read(parties_.pads_used.data(), parties_.pads_used.size() * sizeof(int64_t));
+    for (int64_t pos : parties_.my_index) {
+        if (pos < 0 || pos >= cfg_.n) {
+            throw CheckpointError("corrupt checkpoint: bad party position");
+        }
+    }
+    for (int64_t pos : parties_.views) {
+        if (pos < 0 || pos >= cfg_.n) {
+            throw CheckpointError("corrupt checkpoint: bad party view");
+        }
+    }
+
+    // Re-inserting in saved order reproduces the arrays selection draws from
+    for (LegalMovers* group : {&legal_active_, &legal_silent_}) {
+        const std::vector<int64_t> ids = get_ids(in, m);
+        check_ids(ids, m);
+        *group = LegalMovers(m);
+        for (int64_t pid : ids) {
+            group->update(pid, true);
+        }
+    }
+    network_.load(in, m);
+
+    rng_.state = header.rng_state;
+    rng_.inc = header.rng_inc;
+    iterations_ = header.iterations;
+    std::copy(std::begin(header.move_counts), std::end(header.move_counts), move_counts_);
+    status_evaluations_ = header.status_evaluations;
+    done_ = burned_.size() >= max_utilization_;
+}
+
+}  // namespace ringsim
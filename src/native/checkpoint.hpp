@@ -0,0 +1,81 @@
+// Binary snapshots of a running Scenario (see Scenario::save and restore).
+//
+// Layout, native endianness, every field 8 bytes:
+//   CheckpointHeader                      fixed size, starts with kCheckpointMagic
+//   padding to header.bitset_offset       a multiple of kCheckpointAlign
+//   burned bitset words                   header.bitset_words x uint64
+//   tail: party state, legal movers and the in-flight network updates
+// The bitset sits page aligned so it can be mapped straight from the file.
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+namespace ringsim {
+
+constexpr char kCheckpointMagic[8] = {'R', 'I', 'N', 'G', 'C', 'K', 'P', 'T'};
+constexpr uint64_t kCheckpointVersion = 2;  // 2: messages carry their send tick
+constexpr uint64_t kCheckpointAlign = 4096;
+
+struct CheckpointHeader {
+    char magic[8];
+    uint64_t version;
+    int64_t n, m, d, x;
+    uint64_t flags;  // Config booleans, see checkpoint_flags()
+    uint64_t rng_state, rng_inc;
+    int64_t iterations;
+    int64_t move_counts[4];
+    int64_t status_evaluations;
+    int64_t burned_count;
+    uint64_t bitset_offset;
+    uint64_t bitset_words;
+};
+static_assert(sizeof(CheckpointHeader) == 144, "checkpoint_info() in src/ring_native.py reads this layout");
+
+// Raised for unreadable, truncated or mismatching snapshots and failed writes.
+class CheckpointError : public std::runtime_error {
+public:
+    explicit CheckpointError(const std::string& what) : std::runtime_error(what) {}
+};
+
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(const std::string& path);
+    ~CheckpointWriter();
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void write(const void* data, size_t bytes);
+    void put(int64_t value) { write(&value, sizeof value); }
+    void pad_to(uint64_t offset);
+    uint64_t offset() const { return offset_; }
+    // Flushes and closes the file; throws if anything failed to reach it.
+    void close();
+
+private:
+    std::FILE* file_;
+    uint64_t offset_ = 0;
+};
+
+class CheckpointReader {
+public:
+    explicit CheckpointReader(const std::string& path);
+    ~CheckpointReader();
+    CheckpointReader(const CheckpointReader&) = delete;
+    CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+    void read(void* data, size_t bytes);
+    int64_t get() {
+        int64_t value;
+        read(&value, sizeof value);
+        return value;
+    }
+    void seek(uint64_t offset);
+
+private:
+    std::FILE* file_;
+};
+
+}  // namespace ringsim
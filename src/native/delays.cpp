@@ -0,0 +1,95 @@
+#include "delays.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "ring_core.hpp"
+
+namespace ringsim {
+
+namespace {
+
+constexpr char kTraceMagic[8] = {'R', 'I', 'N', 'G', 'D', 'L', 'Y', '1'};
+constexpr long kTraceHeader = 24;       // TRACE_HEADER in src/delays.py
+constexpr uint64_t kTraceChunk = 65536;  // TRACE_CHUNK in src/delays.py
+
+}  // namespace
+
+DelayModel DelayModel::uniform(int64_t max_delay) { return DelayModel(Kind::Uniform, max_delay); }
+
+DelayModel DelayModel::tables(std::vector<uint64_t> cdf, int64_t width) {
+    DelayModel model(Kind::Tables, width);
+    model.cdf_ = std::move(cdf);
+    return model;
+}
+
+DelayModel DelayModel::trace(const std::string& path) {
+    File file(std::fopen(path.c_str(), "rb"), std::fclose);
+    unsigned char header[kTraceHeader];
+    if (!file || std::fread(header, 1, sizeof header, file.get()) != sizeof header ||
+        std::memcmp(header, kTraceMagic, sizeof kTraceMagic) != 0) {
+        throw std::invalid_argument("not a delay trace: " + path);
+    }
+    uint64_t count;
+    uint32_t largest;
+    std::memcpy(&count, header + 8, sizeof count);
+    std::memcpy(&largest, header + 16, sizeof largest);
+    if (count == 0) {
+        throw std::invalid_argument("empty delay trace: " + path);
+    }
+    DelayModel model(Kind::Trace, largest);
+    model.file_ = std::move(file);
+    model.path_ = path;
+    model.count_ = count;
+    return model;
+}
+
+void DelayModel::refill() {
+    if (read_ == count_) {
+        std::fseek(file_.get(), kTraceHeader, SEEK_SET);
+        read_ = 0;
+    }
+    const uint64_t records = std::min(kTraceChunk, count_ - read_);
+    chunk_.resize(static_cast<size_t>(records));
+    if (std::fread(chunk_.data(), sizeof(uint16_t), chunk_.size(), file_.get()) != chunk_.size()) {
+        throw std::invalid_argument("truncated delay trace: " + path_);
+    }
+    read_ += records;
+    next_ = 0;
+}
+
+int64_t DelayModel::least_delay() const {
+    if (kind_ != Kind::Tables || max_delay_ == 0) {
+        return 0;
+    }
+    const size_t width = static_cast<size_t>(max_delay_);
+    int64_t least = max_delay_;
+    for (size_t row = 0; row < cdf_.size(); row += width) {
+        const auto first = cdf_.begin() + static_cast<std::ptrdiff_t>(row);
+        least = std::min<int64_t>(least, std::upper_bound(first, first + static_cast<std::ptrdiff_t>(width), 0) - first);
+    }
+    return least;
+}
+
+int64_t DelayModel::draw(int64_t sender_id, Rng& rng) {
+    switch (kind_) {
+    case Kind::Uniform:
+        return rng.randint(0, max_delay_);
+    case Kind::Tables: {
+        const size_t width = static_cast<size_t>(max_delay_);
+        const size_t rows = width == 0 ? 1 : cdf_.size() / width;
+        const uint64_t* row = cdf_.data() + (rows == 1 ? 0 : static_cast<size_t>(sender_id - 1) * width);
+        const uint64_t word = rng.next32();
+        return std::upper_bound(row, row + width, word) - row;
+    }
+    case Kind::Trace:
+        if (next_ == chunk_.size()) {
+            refill();
+        }
+        return std::min<int64_t>(chunk_[next_++], max_delay_);
+    }
+    return 0;
+}
+
+}  // namespace ringsim
@@ -0,0 +1,51 @@
+// Delivery delay models of AsynchronousNetwork (src/delays.py).
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ringsim {
+
+class Rng;
+
+// Uniform delays are drawn by the network itself with Rng::randint; every
+// other model goes through draw(). CDF tables hold `width` ascending
+// thresholds per row, P(delay <= k) scaled to 2^32 for k < width, and a
+// draw counts the thresholds at or below one 32-bit word. A single row
+// serves every sender, otherwise row sender_id - 1 does. A trace replays the
+// uint16 records of a file written by delays.write_trace(), streamed in
+// chunks and restarted past the end; it assumes a little-endian host.
+class DelayModel {
+public:
+    static DelayModel uniform(int64_t max_delay);
+    static DelayModel tables(std::vector<uint64_t> cdf, int64_t width);
+    // Throws std::invalid_argument if path is not a readable, non-empty trace
+    static DelayModel trace(const std::string& path);
+
+    bool is_uniform() const { return kind_ == Kind::Uniform; }
+    int64_t max_delay() const { return max_delay_; }
+    // Smallest delay a draw can return: the thresholds at 0, fewest over the rows
+    int64_t least_delay() const;
+    int64_t draw(int64_t sender_id, Rng& rng);
+
+private:
+    enum class Kind { Uniform, Tables, Trace };
+    using File = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+    DelayModel(Kind kind, int64_t max_delay) : kind_(kind), max_delay_(max_delay) {}
+    void refill();
+
+    Kind kind_;
+    int64_t max_delay_;
+    std::vector<uint64_t> cdf_;  // tables: rows of max_delay_ thresholds
+    File file_{nullptr, std::fclose};  // trace
+    std::string path_;
+    uint64_t count_ = 0, read_ = 0;  // records in the trace, records read this pass
+    std::vector<uint16_t> chunk_;
+    size_t next_ = 0;
+};
+
+}  // namespace ringsim
@@ -0,0 +1,341 @@
+#include "fixed_ring.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <vector>
+
+namespace ringsim {
+
+namespace {
+
+// Rng::below inlined for 0 < bound < 2^32: one 32-bit word per attempt,
+// shifted as getrandbits shifts it
+inline uint64_t below(Rng& rng, uint64_t bound) {
+    if (bound >> 32) {
+        return rng.below(bound);
+    }
+    const int shift = __builtin_clzll(bound) - 32;
+    uint64_t r = rng.next32() >> shift;
+    while (r >= bound) {
+        r = rng.next32() >> shift;
+    }
+    return r;
+}
+
+// Updates due at one tick: the latest index of each sender in senders
+template <int M>
+struct Slot {
+    uint32_t senders = 0;
+    int64_t count = 0;  // updates, superseded ones included
+    std::array<int64_t, M> index{};
+};
+
+// Scenario for m = M on the single schedule; party id i + 1 is slot i of
+// every array.
+template <int M>
+class FixedRing {
+public:
+    FixedRing(const Config& cfg, Rng& rng);
+
+    template <bool Timed>
+    void run();
+    int64_t waste() const { return n_ - burned_.size(); }
+    Stats stats() const;
+
+private:
+    static constexpr int front(int i) { return (i + 1) % M; }
+    static constexpr int predecessor(int i) { return (i + M - 1) % M; }
+
+    int64_t gap(int i) const {
+        const int64_t gap = front_[i] - pos_[i];
+        return gap + (n_ & (gap >> 63));
+    }
+    uint32_t legal() const;
+    int64_t skip_target(int i) const;
+    void tick();
+    void skip_idle();
+    bool move_single();
+    void move(int i);
+    void send(int i, int64_t index);
+
+    Rng& rng_;
+    const int64_t n_, d_, d_delay_;
+    const bool skip_drift_, event_driven_, neighbor_only_;
+    const int64_t max_utilization_;
+    std::array<int64_t, M> pos_{};
+    std::array<int64_t, M> front_{};  // each party's view of the party ahead
+    // Active parties in the order they were sampled, then the silent ones
+    std::array<int, M> order_{};
+    int active_count_ = 0;
+    uint32_t active_ = 0;  // bit i: party i + 1 is active
+    BurnedBitset burned_;
+    std::vector<Slot<M>> wheel_;
+    int64_t mask_;
+    int64_t now_ = 0;
+    int64_t pending_ = 0, sent_ = 0, delivered_ = 0, view_updates_ = 0, max_pending_ = 0;
+    int64_t iterations_ = 0, status_evaluations_ = 0;
+    int64_t move_counts_[4] = {0, 0, 0, 0};  // indexed by EventMove
+    double network_s_ = 0.0, moves_s_ = 0.0;
+};
+
+template <int M>
+FixedRing<M>::FixedRing(const Config& cfg, Rng& rng)
+    : rng_(rng),
+      n_(cfg.n),
+      d_(cfg.d),
+      d_delay_(cfg.link_delay < 0 ? cfg.d : cfg.link_delay),
+      skip_drift_(cfg.skip_drift),
+      event_driven_(cfg.event_driven),
+      neighbor_only_(cfg.neighbor_only),
+      max_utilization_(cfg.n - M * cfg.d),
+      burned_(cfg.n) {
+    std::vector<int64_t> all_ids(M);
+    for (int i = 0; i < M; ++i) {
+        all_ids[i] = i + 1;
+        pos_[i] = i * (n_ / M);
+    }
+    for (int i = 0; i < M; ++i) {
+        front_[i] = pos_[front(i)];
+    }
+    for (int64_t pid : sample(all_ids, cfg.x, rng_)) {
+        order_[active_count_++] = static_cast<int>(pid - 1);
+        active_ |= 1u << (pid - 1);
+        burned_.add(pos_[pid - 1]);
+    }
+    int next = active_count_;
+    for (int i = 0; i < M; ++i) {
+        if (!(active_ >> i & 1)) {
+            order_[next++] = i;
+        }
+    }
+    // Updates are due at most max(1, d_delay) ticks ahead
+    int64_t slots = 2;
+    while (slots < d_delay_ + 1) {
+        slots <<= 1;
+    }
+    wheel_.resize(static_cast<size_t>(slots));
+    mask_ = slots - 1;
+}
+
+// Bit i set when party i + 1 has more than d pads up to its view of the party ahead
+template <int M>
+uint32_t FixedRing<M>::legal() const {
+    uint32_t mask = 0;
+    for (int i = 0; i < M; ++i) {
+        mask |= static_cast<uint32_t>(gap(i) > d_) << i;
+    }
+    return mask;
+}
+
+// As Scenario::skip_target
+template <int M>
+int64_t FixedRing<M>::skip_target(int i) const {
+    const int64_t pos = pos_[i];
+    const int64_t fresh = burned_.next_unburned(pos + 1 == n_ ? 0 : pos + 1);
+    int64_t run = n_;
+    if (fresh >= 0) {
+        run = fresh - 1 - pos;
+        run += n_ & (run >> 63);
+    }
+    const int64_t target = pos + std::min(run, gap(i) - d_);
+    return target >= n_ ? target - n_ : target;
+}
+
+template <int M>
+void FixedRing<M>::tick() {
+    now_ += 1;
+    Slot<M>& slot = wheel_[static_cast<size_t>(now_ & mask_)];
+    if (slot.count == 0) {
+        return;
+    }
+    for (int s = 0; s < M; ++s) {
+        int64_t& view = front_[predecessor(s)];
+        view = (slot.senders >> s & 1) ? slot.index[s] : view;
+    }
+    pending_ -= slot.count;
+    delivered_ += slot.count;
+    view_updates_ += slot.count * (neighbor_only_ ? 1 : M - 1);
+    slot.senders = 0;
+    slot.count = 0;
+}
+
+template <int M>
+void FixedRing<M>::skip_idle() {
+    for (int64_t ahead = 1; ahead <= mask_ + 1; ++ahead) {
+        if (wheel_[static_cast<size_t>((now_ + ahead) & mask_)].count != 0) {
+            now_ += ahead - 1;
+            return;
+        }
+    }
+}
+
+template <int M>
+void FixedRing<M>::send(int i, int64_t index) {
+    const int64_t delay = static_cast<int64_t>(below(rng_, static_cast<uint64_t>(d_delay_) + 1));
+    const int64_t due = std::max(now_ + delay, now_ + 1);
+    Slot<M>& slot = wheel_[static_cast<size_t>(due & mask_)];
+    // Later sends overwrite earlier ones due at the same tick, as applying them in order would
+    slot.senders |= 1u << i;
+    slot.index[i] = index;
+    slot.count += 1;
+    pending_ += 1;
+    sent_ += 1;
+    max_pending_ = std::max(max_pending_, pending_);
+}
+
+template <int M>
+void FixedRing<M>::move(int i) {
+    const int64_t pos = pos_[i];
+    int64_t nxt = pos + 1 == n_ ? 0 : pos + 1;
+    uint8_t event = kEventYield;
+    if (active_ >> i & 1) {
+        if (burned_.contains(nxt)) {
+            event = kEventDrift;
+            if (skip_drift_) {
+                nxt = skip_target(i);
+            }
+        } else {
+            event = kEventData;
+            if (!burned_.add(nxt)) {
+                throw SecurityFailure(nxt);
+            }
+        }
+    }
+    pos_[i] = nxt;
+    send(i, nxt);
+    move_counts_[event] += 1;
+}
+
+// Scenario::move_single: a uniform pick among the legal active parties, or
+// else among the legal silent ones
+template <int M>
+bool FixedRing<M>::move_single() {
+    const uint32_t legal_mask = legal();
+    std::array<int, M> active{}, silent{};
+    int found_active = 0, found_silent = 0;
+    for (int k = 0; k < M; ++k) {
+        const int i = order_[k];
+        const int ok = static_cast<int>(legal_mask >> i & 1);
+        const int in_active = static_cast<int>(k < active_count_);
+        active[found_active] = i;
+        silent[found_silent] = i;
+        found_active += ok & in_active;
+        found_silent += ok & (in_active ^ 1);
+    }
+    // Scanning stops after the active group when it has a mover
+    if (found_active > 0) {
+        status_evaluations_ += active_count_ + 1;
+        move(active[below(rng_, static_cast<uint64_t>(found_active))]);
+        return true;
+    }
+    status_evaluations_ += M;
+    if (found_silent > 0) {
+        status_evaluations_ += 1;
+        move(silent[below(rng_, static_cast<uint64_t>(found_silent))]);
+        return true;
+    }
+    return false;
+}
+
+template <int M>
+template <bool Timed>
+void FixedRing<M>::run() {
+    using Clock = std::chrono::steady_clock;
+    // x == 0 ends the run at once; see run_scenario in src/ring_sim.py
+    bool done = burned_.size() >= max_utilization_ || active_count_ == 0;
+    while (!done) {
+        iterations_ += 1;
+        Clock::time_point started, delivered_at;
+        if (Timed) {
+            started = Clock::now();
+        }
+        tick();
+        if (Timed) {
+            delivered_at = Clock::now();
+            network_s_ += std::chrono::duration<double>(delivered_at - started).count();
+        }
+        const bool moved = move_single();
+        if (Timed) {
+            moves_s_ += std::chrono::duration<double>(Clock::now() - delivered_at).count();
+        }
+        if (!moved) {
+            move_counts_[kEventBlocked] += 1;
+            if (pending_ == 0) {
+                break;
+            }
+            if (event_driven_) {
+                skip_idle();
+            }
+        }
+        done = burned_.size() >= max_utilization_;
+    }
+}
+
+template <int M>
+Stats FixedRing<M>::stats() const {
+    Stats stats;
+    stats.ticks = now_;
+    stats.iterations = iterations_;
+    stats.broadcasts = sent_;
+    stats.delivered = delivered_;
+    stats.view_updates = view_updates_;
+    stats.data_moves = move_counts_[kEventData];
+    stats.drift_moves = move_counts_[kEventDrift];
+    stats.yield_moves = move_counts_[kEventYield];
+    stats.blocked_ticks = move_counts_[kEventBlocked];
+    stats.max_queue_depth = max_pending_;
+    stats.status_evaluations = status_evaluations_;
+    stats.network_s = network_s_;
+    stats.moves_s = moves_s_;
+    return stats;
+}
+
+template <int M>
+int64_t run_kernel(const Config& cfg, Rng& rng, Stats* stats) {
+    FixedRing<M> ring(cfg, rng);
+    if (stats != nullptr) {
+        ring.template run<true>();
+        *stats = ring.stats();
+    } else {
+        ring.template run<false>();
+    }
+    return ring.waste();
+}
+
+}  // namespace
+
+int64_t fixed_kernel(const Config& cfg) {
+    if (!cfg.fixed_kernels || cfg.coalesce || cfg.incremental || cfg.batch || cfg.shards > 0 ||
+        cfg.mapped_bitmap || cfg.intervals || cfg.adaptive || cfg.traffic || cfg.telemetry != nullptr ||
+        cfg.profiler != nullptr || !cfg.checkpoint_path.empty() || !cfg.delay_trace.empty() ||
+        cfg.delay_cdf_width >= 0) {
+        return 0;
+    }
+    switch (cfg.m) {
+    case 2:
+    case 3:
+    case 4:
+    case 8:
+        return cfg.m;
+    default:
+        return 0;
+    }
+}
+
+int64_t run_fixed(const Config& cfg, Rng& rng, Stats* stats) {
+    switch (fixed_kernel(cfg)) {
+    case 2:
+        return run_kernel<2>(cfg, rng, stats);
+    case 3:
+        return run_kernel<3>(cfg, rng, stats);
+    case 4:
+        return run_kernel<4>(cfg, rng, stats);
+    case 8:
+        return run_kernel<8>(cfg, rng, stats);
+    default:
+        throw std::invalid_argument("no fixed-m kernel for this configuration");
+    }
+}
+
+}  // namespace ringsim
@@ -0,0 +1,35 @@
+// Kernels of run_scenario specialized for a fixed small m (2, 3, 4 or 8).
+//
+// The ring sizes of the sweep in ring_sim.py's __main__ run on these when
+// Config::fixed_kernels is set. Positions and front views live in
+// std::array<int64_t, M> with every per-party loop unrolled; a party only
+// reads its view of the party ahead, so the m x m view matrix shrinks to
+// those m entries. The status of all parties is computed branch-free and
+// legal movers are compacted without branches. A timing-wheel slot keeps
+// the latest update per sender (applying a slot in send order leaves each
+// view at its latest one anyway), and the wheel has a power-of-two number
+// of slots so the tick indexes it with a mask. Pad indices wrap by a
+// conditional add or subtract, never a runtime modulo.
+//
+// The kernels draw from rng and return waste and Stats exactly as Scenario
+// does for the same configuration.
+#pragma once
+
+#include <cstdint>
+
+#include "ring_core.hpp"
+
+namespace ringsim {
+
+// m of the kernel that run_scenario picks for cfg, or 0 when cfg runs on
+// Scenario: the kernels cover the single schedule with scanned movers and
+// uniform delays, in either propagation mode, with or without skip-ahead
+// Drift and event-driven ticks, on an in-memory bitset. Profiled runs take
+// Scenario, whose phases the profiler names.
+int64_t fixed_kernel(const Config& cfg);
+
+// Runs cfg on the kernel fixed_kernel(cfg) names, which must not be 0.
+// Throws SecurityFailure if a pad would be encrypted twice.
+int64_t run_fixed(const Config& cfg, Rng& rng, Stats* stats);
+
+}  // namespace ringsim
@@ -0,0 +1,53 @@
+#include "pad_allocator.hpp"
+
+namespace ringsim {
+
+AtomicBitset::AtomicBitset(int64_t n) : words_(new std::atomic<uint64_t>[static_cast<size_t>((n + 63) / 64)]) {
+    for (int64_t w = 0; w < (n + 63) / 64; ++w) {
+        words_[w].store(0, std::memory_order_relaxed);
+    }
+}
+
+int64_t AtomicBitset::next_unset(int64_t start, int64_t n) const {
+    const int64_t last = (n - 1) >> 6;
+    // Bits past n in the last word read as set
+    const uint64_t tail = (n & 63) ? ~0ULL << (n & 63) : 0;
+    int64_t w = start >> 6;
+    uint64_t free = ~(words_[w].load(std::memory_order_acquire) | (w == last ? tail : 0)) & (~0ULL << (start & 63));
+    for (int64_t scanned = 0; !free; ++scanned) {
+        if (scanned > last) {
+            return -1;
+        }
+        w = w == last ? 0 : w + 1;
+        free = ~(words_[w].load(std::memory_order_acquire) | (w == last ? tail : 0));
+    }
+    return (w << 6) + __builtin_ctzll(free);
+}
+
+PadAllocator::PadAllocator(int64_t n, int64_t d, int64_t start, int64_t front)
+    : n_(n), d_(d), burned_(n), pos_(start), front_(front) {
+    burned_.claim(start);
+}
+
+int64_t PadAllocator::reserve() {
+    int64_t pos = pos_.load(std::memory_order_acquire);
+    for (;;) {
+        const int64_t front = front_.load(std::memory_order_acquire);
+        const int64_t gap = ((front - pos) % n_ + n_) % n_;
+        if (gap <= d_) {
+            return -1;
+        }
+        const int64_t next = pos + 1 == n_ ? 0 : pos + 1;
+        // On failure pos is reloaded and the gap re-checked against it
+        if (!pos_.compare_exchange_weak(pos, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            continue;
+        }
+        if (burned_.claim(next)) {
+            used_.fetch_add(1, std::memory_order_relaxed);
+            return next;
+        }
+        pos = next;
+    }
+}
+
+}  // namespace ringsim
@@ -0,0 +1,62 @@
+// Lock-free pad reservation for one party with several sending threads.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace ringsim {
+
+// Burned bitset whose bits are claimed with an atomic fetch_or, so that of
+// any number of threads racing for a pad exactly one wins it.
+class AtomicBitset {
+public:
+    explicit AtomicBitset(int64_t n);
+
+    // Sets the bit; returns false if it was already set.
+    bool claim(int64_t idx) {
+        const uint64_t bit = 1ULL << (idx & 63);
+        return !(words_[idx >> 6].fetch_or(bit, std::memory_order_acq_rel) & bit);
+    }
+    bool contains(int64_t idx) const {
+        return (words_[idx >> 6].load(std::memory_order_acquire) >> (idx & 63)) & 1;
+    }
+    // First unset bit at or after start in ring order over n bits, -1 if none
+    int64_t next_unset(int64_t start, int64_t n) const;
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+};
+
+// Hands out fresh pads from one party's arc to concurrent threads without a
+// lock. The party's pointer advances by compare-and-swap only while the gap
+// to its view of the front neighbour stays above d, the bound a blind
+// fetch_add could overshoot, and every pad it passes is claimed in the
+// burned bitset; a pad that was already burned is stepped over (a Drift)
+// instead of being handed out again, so no pad is ever returned twice.
+class PadAllocator {
+public:
+    PadAllocator(int64_t n, int64_t d, int64_t start, int64_t front);
+
+    // A fresh pad index, or -1 when the gap to the front neighbour's view
+    // is exhausted until set_front() reports it has moved on.
+    int64_t reserve();
+
+    // Delivers a new view of the front neighbour's position.
+    void set_front(int64_t index) { front_.store(index, std::memory_order_release); }
+    // Marks a pad burned elsewhere; returns false if it already was.
+    bool burn(int64_t idx) { return burned_.claim(idx); }
+    bool burned(int64_t idx) const { return burned_.contains(idx); }
+    int64_t position() const { return pos_.load(std::memory_order_acquire); }
+    int64_t used() const { return used_.load(std::memory_order_relaxed); }
+
+private:
+    const int64_t n_;
+    const int64_t d_;
+    AtomicBitset burned_;
+    alignas(64) std::atomic<int64_t> pos_;
+    alignas(64) std::atomic<int64_t> front_;
+    alignas(64) std::atomic<int64_t> used_{0};
+};
+
+}  // namespace ringsim
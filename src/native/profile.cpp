@@ -0,0 +1,112 @@
+#include "profile.hpp"
+
+#include <chrono>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ringsim {
+
+namespace {
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+#if defined(__linux__)
+int open_counter(uint64_t config, int group) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = group < 0 ? 1 : 0;  // the leader starts the group
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group, 0));
+}
+#endif
+
+}  // namespace
+
+HardwareCounters::HardwareCounters() : fds_{-1, -1, -1} {
+#if defined(__linux__)
+    const uint64_t events[kCounterCount] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES,
+                                            PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < kCounterCount; ++i) {
+        fds_[i] = open_counter(events[i], fds_[0]);
+        if (fds_[i] < 0) {
+            for (int j = 0; j < i; ++j) {
+                close(fds_[j]);
+                fds_[j] = -1;
+            }
+            return;
+        }
+    }
+    ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+HardwareCounters::~HardwareCounters() {
+#if defined(__linux__)
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+bool HardwareCounters::read(int64_t out[kCounterCount]) const {
+#if defined(__linux__)
+    // PERF_FORMAT_GROUP: the number of events, then one value per event
+    uint64_t values[1 + kCounterCount];
+    if (!available() || ::read(fds_[0], values, sizeof(values)) != static_cast<ssize_t>(sizeof(values))) {
+        return false;
+    }
+    for (int i = 0; i < kCounterCount; ++i) {
+        out[i] = static_cast<int64_t>(values[1 + i]);
+    }
+    return true;
+#else
+    static_cast<void>(out);
+    return false;
+#endif
+}
+
+Profiler::Profiler(int64_t every, bool hardware) : every_(every) {
+    if (hardware) {
+        counters_ = std::make_unique<HardwareCounters>();
+    }
+}
+
+void Profiler::begin(Phase phase) {
+    Open& open = open_[phase];
+    if (hardware()) {
+        counters_->read(open.counters);
+    }
+    open.started = now_ns();
+}
+
+void Profiler::end(Phase phase) {
+    const int64_t ended = now_ns();
+    const Open& open = open_[phase];
+    PhaseTotals& totals = totals_[phase];
+    totals.calls += 1;
+    totals.nanoseconds += ended - open.started;
+    int64_t counts[kCounterCount];
+    if (hardware() && counters_->read(counts)) {
+        for (int i = 0; i < kCounterCount; ++i) {
+            totals.counters[i] += counts[i] - open.counters[i];
+        }
+    }
+}
+
+}  // namespace ringsim
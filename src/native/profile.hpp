@@ -0,0 +1,97 @@
+// Phase profiler of the Scenario loop (profile= in ring_sim.run_scenario).
+//
+// Scopes time the phases of sampled loop iterations: the whole iteration
+// (step), the network tick, the legal-mover computation, the move
+// application and, within it, the broadcast enqueue. One iteration in every
+// `every` is sampled. Where the platform allows it (Linux perf events, see
+// perf_event_paranoid) each scope also reads CPU cycles, cache misses and
+// branch misses of the calling thread; those reads are system calls, so
+// they add to the wall time of the enclosing phases. A Scenario without a
+// profiler pays one null check per scope.
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+namespace ringsim {
+
+enum Phase : int { kPhaseStep, kPhaseTick, kPhaseMovers, kPhaseMove, kPhaseEnqueue, kPhaseCount };
+
+enum Counter : int { kCounterCycles, kCounterCacheMisses, kCounterBranchMisses, kCounterCount };
+
+// Inclusive totals of one phase over the sampled iterations.
+struct PhaseTotals {
+    int64_t calls = 0;
+    int64_t nanoseconds = 0;
+    int64_t counters[kCounterCount] = {0, 0, 0};  // 0 without hardware counters
+};
+
+// A perf event group counting the Counter events of the calling thread in
+// user space; available() is false where the platform refuses to open it.
+class HardwareCounters {
+public:
+    HardwareCounters();
+    ~HardwareCounters();
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    bool available() const { return fds_[0] >= 0; }
+    // Current counts; false if the group could not be read.
+    bool read(int64_t out[kCounterCount]) const;
+
+private:
+    int fds_[kCounterCount];
+};
+
+class Profiler {
+public:
+    // every >= 1; hardware asks for HardwareCounters.
+    Profiler(int64_t every, bool hardware);
+
+    // Called at the start of every loop iteration; decides whether it is sampled.
+    void next_iteration() { sampled_ = iteration_++ % every_ == 0; }
+    bool sampled() const { return sampled_; }
+    void begin(Phase phase);
+    void end(Phase phase);
+
+    bool hardware() const { return counters_ != nullptr && counters_->available(); }
+    const PhaseTotals& totals(Phase phase) const { return totals_[phase]; }
+
+private:
+    struct Open {
+        int64_t started;
+        int64_t counters[kCounterCount];
+    };
+
+    int64_t every_;
+    int64_t iteration_ = 0;
+    bool sampled_ = false;
+    std::unique_ptr<HardwareCounters> counters_;
+    Open open_[kPhaseCount] = {};
+    PhaseTotals totals_[kPhaseCount] = {};
+};
+
+// Times one phase for the rest of the enclosing block when profiler is set
+// and the current iteration is sampled.
+class ProfileScope {
+public:
+    ProfileScope(Profiler* profiler, Phase phase)
+        : profiler_(profiler != nullptr && profiler->sampled() ? profiler : nullptr), phase_(phase) {
+        if (profiler_ != nullptr) {
+            profiler_->begin(phase_);
+        }
+    }
+    ~ProfileScope() {
+        if (profiler_ != nullptr) {
+            profiler_->end(phase_);
+        }
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler* profiler_;
+    Phase phase_;
+};
+
+}  // namespace ringsim
@@ -0,0 +1,296 @@
+// C ABI consumed by src/ring_native.py through ctypes.
+//
+// Every entry point returns a ringsim_status; C++ exceptions never cross
+// this boundary.
+#include "ring_capi.h"
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "checkpoint.hpp"
+#include "fixed_ring.hpp"
+#include "pad_allocator.hpp"
+#include "profile.hpp"
+#include "ring_core.hpp"
+#include "xor_pads.hpp"
+
+namespace {
+
+static_assert(sizeof(ringsim_event) == sizeof(ringsim::Event), "ringsim_event must match ringsim::Event");
+static_assert(offsetof(ringsim_event, move) == offsetof(ringsim::Event, move), "ringsim_event must match ringsim::Event");
+
+thread_local std::string last_error;
+
+// Hands core events to the C sink of the ringsim_config passed as ctx; the
+// core's Event is laid out as ringsim_event.
+void forward_events(void* ctx, const ringsim::Event* events, int64_t count) {
+    const ringsim_config* cfg = static_cast<const ringsim_config*>(ctx);
+    cfg->telemetry(cfg->telemetry_ctx, reinterpret_cast<const ringsim_event*>(events), count);
+}
+
+ringsim_status validate(const ringsim_config* cfg) {
+    if (cfg == nullptr || cfg->n < 1 || cfg->m < 1 || cfg->d < 0 || cfg->x < 0 || cfg->x > cfg->m ||
+        cfg->shards < 0) {
+        return RINGSIM_INVALID_ARGUMENT;
+    }
+    const bool rows = cfg->delay_cdf_rows == 1 || cfg->delay_cdf_rows == cfg->m;
+    if (cfg->delay_cdf != nullptr && (!rows || cfg->delay_cdf_width < 0)) {
+        return RINGSIM_INVALID_ARGUMENT;
+    }
+    if (cfg->traffic != 0 && cfg->arrivals == nullptr) {
+        return RINGSIM_INVALID_ARGUMENT;
+    }
+    if (cfg->profile != nullptr && cfg->profile->every < 1) {
+        return RINGSIM_INVALID_ARGUMENT;
+    }
+    return RINGSIM_OK;
+}
+
+ringsim::Config to_config(const ringsim_config* cfg) {
+    ringsim::Config config{cfg->n, cfg->m, cfg->d, cfg->x, cfg->rng_state, cfg->rng_inc};
+    config.coalesce = cfg->coalesce != 0;
+    config.skip_drift = cfg->skip_drift != 0;
+    config.incremental = cfg->incremental != 0;
+    config.event_driven = cfg->event_driven != 0;
+    config.neighbor_only = cfg->neighbor_only != 0;
+    config.batch = cfg->batch != 0;
+    config.shards = cfg->shards;
+    config.fixed_kernels = cfg->fixed_kernels != 0;
+    config.mapped_bitmap = cfg->mapped_bitmap != 0;
+    config.intervals = cfg->intervals != 0;
+    config.adaptive = cfg->adaptive != 0;
+    config.link_delay = cfg->link_delay;
+    if (cfg->delay_cdf != nullptr) {
+        config.delay_cdf.assign(cfg->delay_cdf, cfg->delay_cdf + cfg->delay_cdf_rows * cfg->delay_cdf_width);
+        config.delay_cdf_width = cfg->delay_cdf_width;
+    }
+    if (cfg->delay_trace != nullptr) {
+        config.delay_trace = cfg->delay_trace;
+    }
+    if (cfg->traffic != 0) {
+        config.traffic = true;
+        for (int64_t i = 0; i < cfg->m; ++i) {
+            const ringsim_arrivals& process = cfg->arrivals[i];
+            config.arrivals.push_back({process.kind, process.rate, process.mean_on, process.mean_off});
+        }
+        if (cfg->message_trace != nullptr) {
+            config.message_trace = cfg->message_trace;
+        }
+        config.traffic_until = cfg->traffic_until;
+        config.latency = cfg->latency;
+        config.latency_ctx = cfg->latency_ctx;
+    }
+    if (cfg->telemetry != nullptr) {
+        config.telemetry = forward_events;
+        config.telemetry_ctx = const_cast<ringsim_config*>(cfg);
+        config.telemetry_capacity = cfg->telemetry_capacity;
+    }
+    if (cfg->checkpoint_path != nullptr) {
+        config.checkpoint_path = cfg->checkpoint_path;
+        config.checkpoint_every = cfg->checkpoint_every;
+    }
+    return config;
+}
+
+// Adds the totals of profiler to the caller's profile.
+void fill_profile(const ringsim::Profiler& profiler, ringsim_profile* out) {
+    static_assert(RINGSIM_PHASES == ringsim::kPhaseCount, "ringsim_profile must cover every Phase");
+    out->hardware_counters = profiler.hardware() ? 1 : 0;
+    for (int phase = 0; phase < ringsim::kPhaseCount; ++phase) {
+        const ringsim::PhaseTotals& totals = profiler.totals(static_cast<ringsim::Phase>(phase));
+        ringsim_phase& into = out->phases[phase];
+        into.calls += totals.calls;
+        into.nanoseconds += totals.nanoseconds;
+        into.cycles += totals.counters[ringsim::kCounterCycles];
+        into.cache_misses += totals.counters[ringsim::kCounterCacheMisses];
+        into.branch_misses += totals.counters[ringsim::kCounterBranchMisses];
+    }
+}
+
+void fill_stats(const ringsim::Stats& stats, ringsim_result* out) {
+    out->ticks = stats.ticks;
+    out->iterations = stats.iterations;
+    out->broadcasts = stats.broadcasts;
+    out->delivered = stats.delivered;
+    out->view_updates = stats.view_updates;
+    out->data_moves = stats.data_moves;
+    out->drift_moves = stats.drift_moves;
+    out->yield_moves = stats.yield_moves;
+    out->blocked_ticks = stats.blocked_ticks;
+    out->max_queue_depth = stats.max_queue_depth;
+    out->status_evaluations = stats.status_evaluations;
+    out->network_s = stats.network_s;
+    out->moves_s = stats.moves_s;
+    out->messages_arrived = stats.messages_arrived;
+}
+
+}  // namespace
+
+extern "C" {
+
+RINGSIM_API const char* ringsim_version(void) { return RINGSIM_VERSION; }
+
+RINGSIM_API const char* ringsim_last_error(void) { return last_error.c_str(); }
+
+RINGSIM_API ringsim_status ringsim_run_scenario(const ringsim_config* cfg, ringsim_result* out) {
+    last_error.clear();
+    const ringsim_status status = validate(cfg);
+    if (status != RINGSIM_OK || out == nullptr) {
+        return RINGSIM_INVALID_ARGUMENT;
+    }
+    ringsim::Rng rng(cfg->rng_state, cfg->rng_inc);
+    ringsim::Stats stats;
+    // A workload run reports messages_arrived through Stats
+    const bool with_stats = cfg->with_stats != 0 || cfg->traffic != 0;
+    std::unique_ptr<ringsim::Profiler> profiler;
+    try {
+        ringsim::Config config = to_config(cfg);
+        if (cfg->profile != nullptr) {
+            profiler = std::make_unique<ringsim::Profiler>(cfg->profile->every, cfg->profile->hardware != 0);
+            config.profiler = profiler.get();
+        }
+        out->waste = ringsim::run_scenario(config, rng, with_stats ? &stats : nullptr);
+        if (profiler != nullptr) {
+            fill_profile(*profiler, cfg->profile);
+        }
+        out->reused_index = -1;
+        fill_stats(stats, out);
+        out->rng_state = rng.state;
+        return RINGSIM_OK;
+    } catch (const ringsim::SecurityFailure& failure) {
+        if (profiler != nullptr) {
+            fill_profile(*profiler, cfg->profile);
+        }
+        out->reused_index = failure.index;
+        out->rng_state = rng.state;
+        return RINGSIM_SECURITY_FAILURE;
+    } catch (const ringsim::CheckpointError& error) {
+        last_error = error.what();
+        return RINGSIM_CHECKPOINT_ERROR;
+    } catch (const std::invalid_argument& error) {
+        last_error = error.what();
+        return RINGSIM_INVALID_ARGUMENT;
+    } catch (const std::exception&) {
+        return RINGSIM_INTERNAL_ERROR;
+    }
+}
+
+RINGSIM_API ringsim_status ringsim_run_batch(const ringsim_config* cfg, int64_t count, const uint64_t* rng_state,
+                                             const uint64_t* rng_inc, ringsim_result* out) {
+    last_error.clear();
+    const ringsim_status status = validate(cfg);
+    const bool buffers = count == 0 || (rng_state != nullptr && rng_inc != nullptr && out != nullptr);
+    // A snapshot file, like a workload's latency stream, belongs to one scenario
+    if (status != RINGSIM_OK || count < 0 || !buffers || cfg->checkpoint_path != nullptr || cfg->traffic != 0 ||
+        cfg->profile != nullptr) {
+        return RINGSIM_INVALID_ARGUMENT;
+    }
+    try {
+        std::vector<ringsim::Rng> rngs;
+        rngs.reserve(static_cast<size_t>(count));
+        for (int64_t i = 0; i < count; ++i) {
+            rngs.emplace_back(rng_state[i], rng_inc[i]);
+        }
+        const std::vector<ringsim::BatchOutcome> outcomes =
+            ringsim::run_batch(to_config(cfg), rngs, cfg->with_stats != 0);
+        ringsim_status result = RINGSIM_OK;
+        for (int64_t i = 0; i < count; ++i) {
+            out[i].waste = outcomes[i].waste;
+            out[i].reused_index = outcomes[i].reused_index;
+            out[i].rng_state = rngs[i].state;
+            fill_stats(outcomes[i].stats, &out[i]);
+            if (outcomes[i].reused_index >= 0) {
+                result = RINGSIM_SECURITY_FAILURE;
+            }
+        }
+        return result;
+    } catch (const std::invalid_argument& error) {
+        last_error = error.what();
+        return RINGSIM_INVALID_ARGUMENT;
+    } catch (const std::exception&) {
+        return RINGSIM_INTERNAL_ERROR;
+    }
+}
+
+RINGSIM_API void ringsim_xor_pads(const uint8_t* data, const uint8_t* pad, uint8_t* out, int64_t bytes) {
+    if (bytes > 0) {
+        ringsim::xor_pads(data, pad, out, static_cast<size_t>(bytes));
+    }
+}
+
+RINGSIM_API const char* ringsim_xor_kernel(void) { return ringsim::xor_kernel_name(); }
+
+RINGSIM_API int64_t ringsim_fixed_kernel(const ringsim_config* cfg) {
+    if (validate(cfg) != RINGSIM_OK) {
+        return 0;
+    }
+    try {
+        return ringsim::fixed_kernel(to_config(cfg));
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+struct ringsim_allocator {
+    ringsim::PadAllocator impl;
+};
+
+RINGSIM_API ringsim_allocator* ringsim_allocator_create(int64_t n, int64_t d, int64_t start, int64_t front) {
+    if (n < 1 || d < 0 || start < 0 || start >= n || front < 0 || front >= n) {
+        return nullptr;
+    }
+    try {
+        return new ringsim_allocator{ringsim::PadAllocator(n, d, start, front)};
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+RINGSIM_API void ringsim_allocator_destroy(ringsim_allocator* alloc) { delete alloc; }
+
+RINGSIM_API int64_t ringsim_allocator_reserve(ringsim_allocator* alloc) { return alloc->impl.reserve(); }
+
+RINGSIM_API void ringsim_allocator_set_front(ringsim_allocator* alloc, int64_t front) {
+    alloc->impl.set_front(front);
+}
+
+RINGSIM_API int32_t ringsim_allocator_burn(ringsim_allocator* alloc, int64_t index) {
+    return alloc->impl.burn(index) ? 1 : 0;
+}
+
+RINGSIM_API int64_t ringsim_allocator_position(const ringsim_allocator* alloc) { return alloc->impl.position(); }
+
+RINGSIM_API int64_t ringsim_allocator_used(const ringsim_allocator* alloc) { return alloc->impl.used(); }
+
+RINGSIM_API ringsim_status ringsim_allocator_contend(ringsim_allocator* alloc, int32_t threads, int64_t attempts,
+                                                   int64_t* out) {
+    if (alloc == nullptr || threads < 1 || attempts < 0 || out == nullptr) {
+        return RINGSIM_INVALID_ARGUMENT;
+    }
+    std::vector<std::thread> pool;
+    ringsim_status status = RINGSIM_OK;
+    try {
+        pool.reserve(static_cast<size_t>(threads));
+        for (int32_t t = 0; t < threads; ++t) {
+            int64_t* results = out + t * attempts;
+            pool.emplace_back([alloc, attempts, results] {
+                for (int64_t i = 0; i < attempts; ++i) {
+                    results[i] = alloc->impl.reserve();
+                }
+            });
+        }
+    } catch (const std::exception&) {
+        status = RINGSIM_INTERNAL_ERROR;  // threads that did start still finish
+    }
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    return status;
+}
+
+}  // extern "C"
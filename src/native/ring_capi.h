@@ -0,0 +1,183 @@
+/* C ABI of the native ring simulation core. Layouts must stay in sync with
+ * the ctypes structures in src/ring_native.py. */
+#ifndef RINGSIM_CAPI_H
+#define RINGSIM_CAPI_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define RINGSIM_API __declspec(dllexport)
+#else
+#define RINGSIM_API __attribute__((visibility("default")))
+#endif
+
+#define RINGSIM_VERSION "1"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum ringsim_status {
+    RINGSIM_OK = 0,
+    RINGSIM_SECURITY_FAILURE = 1,
+    RINGSIM_INVALID_ARGUMENT = 2, /* ringsim_last_error() may say more */
+    RINGSIM_INTERNAL_ERROR = 3,
+    RINGSIM_CHECKPOINT_ERROR = 4 /* see ringsim_last_error() */
+} ringsim_status;
+
+/* One telemetry record; the layout of EVENT in src/telemetry.py. */
+typedef struct ringsim_event {
+    int64_t tick;
+    int64_t index;       /* pad index moved to, -1 for a blocked tick */
+    int32_t queue_depth; /* updates in flight after the event */
+    int32_t party;       /* 0 for a blocked tick */
+    uint8_t move;        /* 0 Data, 1 Drift, 2 Yield, 3 Blocked */
+    uint8_t padding[7];
+} ringsim_event;
+
+/* Receives each full telemetry buffer, and the partial one when a run ends. */
+typedef void (*ringsim_telemetry_fn)(void* ctx, const ringsim_event* events, int64_t count);
+
+/* Arrival process of one party, see src/traffic.py. */
+typedef struct ringsim_arrivals {
+    int32_t kind;    /* 0 never sends, 1 Poisson, 2 on/off */
+    int32_t padding;
+    double rate;     /* messages per tick (while on) */
+    double mean_on;  /* on/off: mean period lengths in ticks */
+    double mean_off;
+} ringsim_arrivals;
+
+/* Totals of one profiled phase over the sampled iterations, see
+ * src/native/profile.hpp; the counters stay 0 without hardware counters. */
+typedef struct ringsim_phase {
+    int64_t calls;
+    int64_t nanoseconds;
+    int64_t cycles;
+    int64_t cache_misses;
+    int64_t branch_misses;
+} ringsim_phase;
+
+#define RINGSIM_PHASES 5 /* step, tick, movers, move, enqueue */
+
+typedef struct ringsim_profile {
+    int64_t every;             /* sample one loop iteration in every */
+    int32_t hardware;          /* ask for perf event counters */
+    int32_t hardware_counters; /* out: whether they could be read */
+    ringsim_phase phases[RINGSIM_PHASES]; /* out: added to by each run */
+} ringsim_profile;
+
+/* Receives the queueing latencies, in ticks, of sent messages in chunks. */
+typedef void (*ringsim_latency_fn)(void* ctx, const int64_t* latencies, int64_t count);
+
+typedef struct ringsim_config {
+    int64_t n;
+    int64_t m;
+    int64_t d;
+    int64_t x;
+    uint64_t rng_state; /* PCG32 state and increment, see src/rng.py */
+    uint64_t rng_inc;
+    int32_t coalesce;   /* latest-position-wins delivery */
+    int32_t skip_drift; /* cross burned runs in a single Drift */
+    int32_t incremental; /* maintain legal movers incrementally */
+    int32_t event_driven; /* jump over ticks in which nothing can move */
+    int32_t neighbor_only; /* deliver updates to the ring predecessor only */
+    int32_t batch;         /* move every non-conflicting legal party per tick */
+    int32_t mapped_bitmap; /* keep the burned bitset in a mapped temporary file */
+    int32_t intervals;     /* track burned pads as sorted runs instead of a bitset */
+    int32_t adaptive;      /* per-party gap thresholds from observed delays */
+    int64_t link_delay;    /* worst delivery delay drawn by the network, < 0 for d */
+    /* Optional delay model replacing the uniform draw (see src/delays.py):
+     * delay_cdf_rows rows of delay_cdf_width CDF thresholds, one row shared
+     * by all senders or one per sender, or else a trace file to replay. */
+    const uint64_t* delay_cdf;
+    int64_t delay_cdf_rows;
+    int64_t delay_cdf_width;
+    const char* delay_trace;
+    /* Optional workload replacing the x saturated senders (src/traffic.py):
+     * m arrival processes, or else a message trace to replay when
+     * message_trace is set; arrivals after traffic_until >= 0 are dropped. */
+    int32_t traffic;
+    int32_t traffic_padding;
+    const ringsim_arrivals* arrivals;
+    const char* message_trace;
+    int64_t traffic_until;
+    ringsim_latency_fn latency; /* optional latency sink */
+    void* latency_ctx;
+    ringsim_telemetry_fn telemetry; /* optional event sink, NULL to disable */
+    void* telemetry_ctx;
+    int64_t telemetry_capacity; /* events buffered between calls to telemetry */
+    /* Optional snapshot file: an existing one is resumed, a new one is saved
+     * every checkpoint_every iterations and removed when the run ends. */
+    const char* checkpoint_path;
+    int64_t checkpoint_every;
+    int64_t shards; /* sharded schedule on this many threads, 0 for the others */
+    int32_t fixed_kernels; /* run m in {2,3,4,8} on the specialized kernels where they apply */
+    int32_t with_stats;    /* fill the run counters of ringsim_result; timing costs a clock read per step */
+    ringsim_profile* profile; /* optional phase profile of the run, NULL to disable */
+} ringsim_config;
+
+typedef struct ringsim_result {
+    int64_t waste;
+    int64_t reused_index; /* set on RINGSIM_SECURITY_FAILURE, else -1 */
+    uint64_t rng_state;   /* generator state after the run */
+    int64_t messages_arrived; /* workload runs: messages queued by arrivals */
+    /* run counters, see ScenarioStats in src/ring_sim.py; 0 unless with_stats
+     * (messages_arrived is always set for workload runs) */
+    int64_t ticks;
+    int64_t iterations;
+    int64_t broadcasts;
+    int64_t delivered;
+    int64_t view_updates;
+    int64_t data_moves;
+    int64_t drift_moves;
+    int64_t yield_moves;
+    int64_t blocked_ticks;
+    int64_t max_queue_depth;
+    int64_t status_evaluations;
+    double network_s; /* wall time delivering updates */
+    double moves_s;   /* wall time selecting and applying moves */
+} ringsim_result;
+
+RINGSIM_API const char* ringsim_version(void);
+/* Message of the last RINGSIM_CHECKPOINT_ERROR on the calling thread. */
+RINGSIM_API const char* ringsim_last_error(void);
+RINGSIM_API ringsim_status ringsim_run_scenario(const ringsim_config* cfg, ringsim_result* out);
+/* Runs count independent scenarios of cfg in one call; scenario i draws from
+ * (rng_state[i], rng_inc[i]) instead of cfg's generator and reports in out[i].
+ * Returns RINGSIM_SECURITY_FAILURE if any scenario failed; the others still
+ * run to the end. Checkpoints, workloads and profiles are not supported here. */
+RINGSIM_API ringsim_status ringsim_run_batch(const ringsim_config* cfg, int64_t count, const uint64_t* rng_state,
+                                             const uint64_t* rng_inc, ringsim_result* out);
+/* out[i] = data[i] ^ pad[i] for bytes bytes with the widest SIMD kernel the
+ * CPU supports; out may alias data. */
+RINGSIM_API void ringsim_xor_pads(const uint8_t* data, const uint8_t* pad, uint8_t* out, int64_t bytes);
+/* "avx512", "avx2", "neon" or "scalar". */
+RINGSIM_API const char* ringsim_xor_kernel(void);
+/* m of the specialized kernel ringsim_run_scenario would run cfg on, 0 for
+ * the generic engine (or an invalid cfg). */
+RINGSIM_API int64_t ringsim_fixed_kernel(const ringsim_config* cfg);
+
+/* Lock-free pad reservation for the sending threads of one party, see
+ * src/native/pad_allocator.hpp. Every function but create and destroy may be
+ * called from any number of threads at once. create returns NULL for an
+ * invalid configuration. */
+typedef struct ringsim_allocator ringsim_allocator;
+RINGSIM_API ringsim_allocator* ringsim_allocator_create(int64_t n, int64_t d, int64_t start, int64_t front);
+RINGSIM_API void ringsim_allocator_destroy(ringsim_allocator* alloc);
+/* A fresh pad index, or -1 while the gap to the front neighbour is at most d. */
+RINGSIM_API int64_t ringsim_allocator_reserve(ringsim_allocator* alloc);
+RINGSIM_API void ringsim_allocator_set_front(ringsim_allocator* alloc, int64_t front);
+/* Marks a pad burned by another party; returns 0 if it already was. */
+RINGSIM_API int32_t ringsim_allocator_burn(ringsim_allocator* alloc, int64_t index);
+RINGSIM_API int64_t ringsim_allocator_position(const ringsim_allocator* alloc);
+RINGSIM_API int64_t ringsim_allocator_used(const ringsim_allocator* alloc);
+/* Starts threads threads that each call reserve attempts times, thread t
+ * writing its results to out[t * attempts] onwards, and waits for them. */
+RINGSIM_API ringsim_status ringsim_allocator_contend(ringsim_allocator* alloc, int32_t threads, int64_t attempts,
+                                                   int64_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RINGSIM_CAPI_H */
@@ -0,0 +1,558 @@
+#include "ring_core.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "checkpoint.hpp"
+#include "fixed_ring.hpp"
+#include "sharded.hpp"
+
+namespace ringsim {
+
+uint64_t Rng::getrandbits(int k) {
+    uint64_t result = 0;
+    for (int shift = 0; k > 0; shift += 32, k -= 32) {
+        uint64_t word = next32();
+        if (k < 32) {
+            word >>= 32 - k;
+        }
+        result |= word << shift;
+    }
+    return result;
+}
+
+uint64_t Rng::below(uint64_t bound) {
+    const int k = bound == 0 ? 0 : 64 - __builtin_clzll(bound);
+    uint64_t r = getrandbits(k);
+    while (r >= bound) {
+        r = getrandbits(k);
+    }
+    return r;
+}
+
+int64_t DelayEstimator::add(int64_t delay) {
+    const int64_t cap = static_cast<int64_t>(counts_.size()) - 1;
+    delay = std::min(delay, cap);
+    counts_[delay] += 1;
+    total_ += 1;
+    if (delay <= estimate_) {
+        covered_ += 1;
+    }
+    if (++since_decay_ == kAdaptiveWindow) {
+        // Halve rounding up, so no bucket empties
+        total_ = covered_ = 0;
+        for (int64_t value = 0; value <= cap; ++value) {
+            counts_[value] = (counts_[value] + 1) >> 1;
+            total_ += counts_[value];
+            covered_ += value <= estimate_ ? counts_[value] : 0;
+        }
+        since_decay_ = 0;
+    }
+    const int64_t need = kAdaptivePercentile * total_;
+    while (covered_ * 100 < need) {
+        covered_ += counts_[++estimate_];
+    }
+    while (estimate_ > 0 && (covered_ - counts_[estimate_]) * 100 >= need) {
+        covered_ -= counts_[estimate_--];
+    }
+    return estimate_;
+}
+
+PartyState::PartyState(int64_t n, int64_t m, int64_t d)
+    : n(n), m(m), d(d), views(m * m), my_index(m), pads_used(m, 0), thresholds(m, d), reserve(m * d) {
+    for (int64_t i = 0; i < m; ++i) {
+        my_index[i] = i * (n / m);
+    }
+    for (int64_t row = 0; row < m; ++row) {
+        std::copy(my_index.begin(), my_index.end(), views.begin() + row * m);
+    }
+}
+
+void PartyState::broadcast_update(int64_t sender_id, int64_t index) {
+    const int64_t col = sender_id - 1;
+    const int64_t own = views[col * m + col];
+    for (int64_t row = 0; row < m; ++row) {
+        views[row * m + col] = index;
+    }
+    views[col * m + col] = own;
+}
+
+void PartyState::observe_delay(int64_t sender_id, int64_t delay) {
+    const int64_t reader = (sender_id + m - 2) % m;
+    DelayEstimator& estimator = estimators[reader];
+    const int64_t estimate = estimator.add(delay);
+    if (estimator.total() < kAdaptiveMinSamples) {
+        return;
+    }
+    const int64_t threshold = std::min(d, std::max<int64_t>(1, estimate));
+    reserve += threshold - thresholds[reader];
+    thresholds[reader] = threshold;
+}
+
+void AsynchronousNetwork::send_broadcast(int64_t sender_id, int64_t new_index, Rng& rng) {
+    const int64_t delay = delays_.is_uniform() ? rng.randint(0, d_delay_) : delays_.draw(sender_id, rng);
+    const int64_t delivery_time = current_time + delay;
+    // Messages are delivered on the next tick at the earliest
+    const int64_t due = delivery_time > current_time ? delivery_time : current_time + 1;
+    if (coalesce_) {
+        supersede(sender_id, due);
+    }
+    bucket(due).push_back({delivery_time, sender_id, new_index, current_time});
+    pending_ += 1;
+    sent_ += 1;
+    max_pending_ = std::max(max_pending_, pending_);
+}
+
+int64_t AsynchronousNetwork::skip_idle() {
+    const int64_t slots = static_cast<int64_t>(wheel_.size());
+    for (int64_t ahead = 1; ahead <= slots; ++ahead) {
+        if (!bucket(current_time + ahead).empty()) {
+            current_time += ahead - 1;
+            return ahead - 1;
+        }
+    }
+    return 0;
+}
+
+void AsynchronousNetwork::supersede(int64_t sender_id, int64_t due) {
+    std::deque<int64_t>& inflight = inflight_[sender_id - 1];
+    while (!inflight.empty() && inflight.back() >= due) {
+        std::vector<Message>& stale = bucket(inflight.back());
+        for (size_t i = 0; i < stale.size(); ++i) {
+            if (stale[i].sender_id == sender_id) {
+                stale.erase(stale.begin() + static_cast<std::ptrdiff_t>(i));
+                break;
+            }
+        }
+        inflight.pop_back();
+        pending_ -= 1;
+        superseded_ += 1;
+    }
+    inflight.push_back(due);
+}
+
+bool AsynchronousNetwork::tick(PartyState& parties, std::vector<int64_t>* updated_senders) {
+    current_time += 1;
+    std::vector<Message>& due = bucket(current_time);
+    if (due.empty()) {
+        return false;
+    }
+    const bool observe = parties.tracks_delays() && parties.m > 1;
+    for (const Message& msg : due) {
+        if (coalesce_) {
+            inflight_[msg.sender_id - 1].pop_front();
+        }
+        if (observe) {
+            parties.observe_delay(msg.sender_id, current_time - msg.sent_time);
+        }
+        if (!neighbor_only_) {
+            parties.broadcast_update(msg.sender_id, msg.index);
+            view_updates_ += parties.m - 1;
+        } else if (parties.m > 1) {
+            parties.neighbor_update(msg.sender_id, msg.index);
+            view_updates_ += 1;
+        }
+        if (updated_senders != nullptr) {
+            updated_senders->push_back(msg.sender_id);
+        }
+    }
+    pending_ -= static_cast<int64_t>(due.size());
+    delivered_ += static_cast<int64_t>(due.size());
+    due.clear();
+    return true;
+}
+
+DelayModel delay_model(const Config& cfg) {
+    if (!cfg.delay_trace.empty()) {
+        return DelayModel::trace(cfg.delay_trace);
+    }
+    if (cfg.delay_cdf_width >= 0) {
+        return DelayModel::tables(cfg.delay_cdf, cfg.delay_cdf_width);
+    }
+    return DelayModel::uniform(cfg.link_delay < 0 ? cfg.d : cfg.link_delay);
+}
+
+std::vector<int64_t> sample(std::vector<int64_t> pool, int64_t k, Rng& rng) {
+    const int64_t size = static_cast<int64_t>(pool.size());
+    std::vector<int64_t> result(k);
+    for (int64_t i = 0; i < k; ++i) {
+        const int64_t j = static_cast<int64_t>(rng.below(size - i));
+        result[i] = pool[j];
+        pool[j] = pool[size - i - 1];
+    }
+    return result;
+}
+
+namespace {
+
+bool checkpoint_exists(const std::string& path) {
+    if (std::FILE* file = std::fopen(path.c_str(), "rb")) {
+        std::fclose(file);
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+Scenario::Scenario(const Config& cfg, Rng& rng, bool timed)
+    : cfg_(cfg),
+      rng_(rng),
+      network_(delay_model(cfg), cfg.m, cfg.coalesce, cfg.neighbor_only),
+      all_ids_(cfg.m),
+      is_active_(cfg.m + 1, 0),
+      parties_(cfg.n, cfg.m, cfg.d),
+      burned_(cfg.n, cfg.intervals, cfg.mapped_bitmap),
+      max_utilization_(cfg.n - cfg.m * cfg.d),
+      legal_active_(cfg.m),
+      legal_silent_(cfg.m),
+      telemetry_(cfg.telemetry, cfg.telemetry_ctx, cfg.telemetry_capacity),
+      timed_(timed) {
+    const int64_t m = cfg_.m;
+    for (int64_t i = 0; i < m; ++i) {
+        all_ids_[i] = i + 1;
+    }
+    if (cfg_.adaptive) {
+        parties_.track_delays(std::min(cfg_.d, network_.d_delay()));
+    }
+    if (cfg_.traffic) {
+        workload_ = std::make_unique<Workload>(cfg_.arrivals, cfg_.message_trace, cfg_.traffic_until,
+                                               cfg_.latency, cfg_.latency_ctx);
+        if (static_cast<int64_t>(cfg_.arrivals.size()) != m ||
+            static_cast<int64_t>(workload_->senders().size()) != cfg_.x) {
+            throw std::invalid_argument("the workload does not match m and x");
+        }
+        // Senders are active while their queue holds messages
+        active_ids_ = workload_->senders();
+    } else {
+        active_ids_ = sample(all_ids_, cfg_.x, rng_);
+        for (int64_t pid : active_ids_) {
+            is_active_[pid] = 1;
+        }
+    }
+    std::vector<char> sender(m + 1, 0);
+    for (int64_t pid : active_ids_) {
+        sender[pid] = 1;
+    }
+    for (int64_t pid : all_ids_) {
+        if (!sender[pid]) {
+            silent_ids_.push_back(pid);
+        }
+    }
+
+    // Initially, we only burn the starting positions of the ACTIVE IDs to track progress
+    for (int64_t pid : active_ids_) {
+        burned_.add(parties_.my_index[pid - 1]);
+    }
+
+    if (cfg_.incremental) {
+        for (int64_t pid : all_ids_) {
+            refresh(pid);
+        }
+    }
+    if (workload_) {
+        workload_->reset(rng_);
+    }
+    scanned_.reserve(m);
+    rotation_.reserve(m);
+    claimed_.reserve(m);
+    // x == 0 ends the run at once; see run_scenario in src/ring_sim.py
+    done_ = burned_.size() >= max_utilization_ || active_ids_.empty();
+}
+
+Move Scenario::move_status(int64_t p_id, int64_t& next_idx) const {
+    status_evaluations_ += 1;
+    const int64_t n = cfg_.n;
+    const int64_t pos = parties_.my_index[p_id - 1];
+    int64_t gap = parties_.view(p_id, (p_id % cfg_.m) + 1) - pos;
+    if (gap < 0) {
+        gap += n;
+    }
+    next_idx = pos + 1 == n ? 0 : pos + 1;
+    if (gap > parties_.thresholds[p_id - 1]) {
+        return burned_.contains(next_idx) ? Move::Drift : Move::Data;
+    }
+    return Move::Blocked;
+}
+
+// Furthest Drift target: just before the next fresh pad, within the safe gap
+int64_t Scenario::skip_target(int64_t p_id) const {
+    const int64_t n = cfg_.n;
+    const int64_t pos = parties_.my_index[p_id - 1];
+    int64_t gap = parties_.view(p_id, (p_id % cfg_.m) + 1) - pos;
+    if (gap < 0) {
+        gap += n;
+    }
+    const int64_t fresh = burned_.next_unburned(pos + 1 == n ? 0 : pos + 1);
+    int64_t run = n;
+    if (fresh >= 0) {
+        run = fresh - 1 - pos;
+        if (run < 0) {
+            run += n;
+        }
+    }
+    return (pos + std::min(run, gap - parties_.thresholds[p_id - 1])) % n;
+}
+
+void Scenario::refresh(int64_t p_id) {
+    int64_t unused;
+    LegalMovers& group = is_active_[p_id] ? legal_active_ : legal_silent_;
+    group.update(p_id, move_status(p_id, unused) != Move::Blocked);
+}
+
+// Legal movers of one group, re-evaluated per tick unless kept incrementally
+const std::vector<int64_t>& Scenario::legal_movers(bool active) {
+    ProfileScope scope(cfg_.profiler, kPhaseMovers);
+    if (cfg_.incremental) {
+        return active ? legal_active_.ids : legal_silent_.ids;
+    }
+    scanned_.clear();
+    int64_t unused;
+    if (workload_) {
+        for (int64_t pid : all_ids_) {
+            if ((is_active_[pid] != 0) == active && move_status(pid, unused) != Move::Blocked) {
+                scanned_.push_back(pid);
+            }
+        }
+        return scanned_;
+    }
+    for (int64_t pid : active ? active_ids_ : silent_ids_) {
+        if (move_status(pid, unused) != Move::Blocked) {
+            scanned_.push_back(pid);
+        }
+    }
+    return scanned_;
+}
+
+void Scenario::move(int64_t p_id, Move status, int64_t nxt) {
+    ProfileScope scope(cfg_.profiler, kPhaseMove);
+    uint8_t event = kEventYield;
+    if (is_active_[p_id]) {
+        event = status == Move::Data ? kEventData : kEventDrift;
+        if (status == Move::Drift && cfg_.skip_drift) {
+            nxt = skip_target(p_id);
+        }
+        if (status == Move::Data) {
+            if (!burned_.add(nxt)) {
+                if (telemetry_.enabled()) {
+                    telemetry_.flush();
+                }
+                throw SecurityFailure(nxt);
+            }
+            parties_.pads_used[p_id - 1] += 1;
+            // An emptied queue makes the party idle; refresh() below regroups it
+            if (workload_ && workload_->take(p_id, network_.current_time)) {
+                is_active_[p_id] = 0;
+                if (cfg_.incremental) {
+                    legal_active_.update(p_id, false);
+                }
+            }
+        }
+    }
+    parties_.my_index[p_id - 1] = nxt;
+    burned_.touch(p_id, nxt);
+    {
+        ProfileScope enqueue(cfg_.profiler, kPhaseEnqueue);
+        network_.send_broadcast(p_id, nxt, rng_);
+    }
+    move_counts_[event] += 1;
+    if (telemetry_.enabled()) {
+        telemetry_.record(network_.current_time, p_id, event, nxt, network_.pending());
+    }
+    if (cfg_.incremental) {
+        refresh(p_id);
+    }
+}
+
+bool Scenario::move_batch() {
+    // Every legal party moves, unless an earlier mover claimed its next index
+    rotation_.clear();
+    {
+        ProfileScope scope(cfg_.profiler, kPhaseMovers);
+        if (cfg_.incremental) {
+            rotation_.insert(rotation_.end(), legal_active_.ids.begin(), legal_active_.ids.end());
+            rotation_.insert(rotation_.end(), legal_silent_.ids.begin(), legal_silent_.ids.end());
+        } else {
+            int64_t unused;
+            for (int64_t pid : all_ids_) {
+                if (move_status(pid, unused) != Move::Blocked) {
+                    rotation_.push_back(pid);
+                }
+            }
+        }
+    }
+    if (rotation_.empty()) {
+        return false;
+    }
+    const size_t start = rng_.below(rotation_.size());
+    std::rotate(rotation_.begin(), rotation_.begin() + static_cast<std::ptrdiff_t>(start), rotation_.end());
+    claimed_.clear();
+    for (int64_t pid : rotation_) {
+        if (burned_.size() >= max_utilization_) {
+            break;
+        }
+        int64_t nxt;
+        const Move status = move_status(pid, nxt);
+        if (claimed_.insert(nxt).second) {
+            move(pid, status, nxt);
+        }
+    }
+    return true;
+}
+
+bool Scenario::move_single() {
+    // 1. Priority: Active senders (encrypt or drift)
+    // 2. Priority: Silent parties (always jump/drift, never burn)
+    for (bool active : {true, false}) {
+        const std::vector<int64_t>& movers = legal_movers(active);
+        if (!movers.empty()) {
+            const int64_t pid = movers[rng_.below(movers.size())];
+            int64_t nxt;
+            const Move status = move_status(pid, nxt);
+            move(pid, status, nxt);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Scenario::arrive() {
+    workload_->arrive(network_.current_time, rng_, became_busy_);
+    for (int64_t pid : became_busy_) {
+        is_active_[pid] = 1;
+        if (cfg_.incremental) {
+            legal_silent_.update(pid, false);
+            refresh(pid);
+        }
+    }
+    became_busy_.clear();
+}
+
+bool Scenario::step() {
+    if (done_) {
+        return false;
+    }
+    iterations_ += 1;
+    if (cfg_.profiler != nullptr) {
+        cfg_.profiler->next_iteration();
+    }
+    ProfileScope scope(cfg_.profiler, kPhaseStep);
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point started, delivered_at;
+    if (timed_) {
+        started = Clock::now();
+    }
+    if (cfg_.incremental) {
+        {
+            ProfileScope tick(cfg_.profiler, kPhaseTick);
+            network_.tick(parties_, &updated_senders_);
+        }
+        // Only the ring predecessor of a sender reads its position
+        ProfileScope movers(cfg_.profiler, kPhaseMovers);
+        for (int64_t sender_id : updated_senders_) {
+            refresh((sender_id + cfg_.m - 2) % cfg_.m + 1);
+        }
+        updated_senders_.clear();
+    } else {
+        ProfileScope tick(cfg_.profiler, kPhaseTick);
+        network_.tick(parties_);
+    }
+    if (cfg_.adaptive) {
+        max_utilization_ = cfg_.n - parties_.reserve;
+    }
+    if (workload_) {
+        arrive();
+    }
+
+    if (timed_) {
+        delivered_at = Clock::now();
+        network_s_ += std::chrono::duration<double>(delivered_at - started).count();
+    }
+
+    const bool moved_in_tick = cfg_.batch ? move_batch() : move_single();
+    if (timed_) {
+        moves_s_ += std::chrono::duration<double>(Clock::now() - delivered_at).count();
+    }
+    if (!moved_in_tick) {
+        move_counts_[kEventBlocked] += 1;
+        if (telemetry_.enabled()) {
+            telemetry_.record(network_.current_time, 0, kEventBlocked, -1, network_.pending());
+        }
+        if (network_.empty()) {
+            done_ = true;
+        } else if (cfg_.event_driven) {
+            network_.skip_idle();
+        }
+    }
+    done_ = done_ || (workload_ && workload_->finished()) || burned_.size() >= max_utilization_;
+    if (done_ && telemetry_.enabled()) {
+        telemetry_.flush();
+    }
+    if (done_ && workload_) {
+        workload_->flush();
+    }
+    return !done_;
+}
+
+Stats Scenario::stats() const {
+    Stats stats;
+    stats.ticks = network_.current_time;
+    stats.iterations = iterations_;
+    stats.broadcasts = network_.sent();
+    stats.delivered = network_.delivered();
+    stats.view_updates = network_.view_updates();
+    stats.data_moves = move_counts_[kEventData];
+    stats.drift_moves = move_counts_[kEventDrift];
+    stats.yield_moves = move_counts_[kEventYield];
+    stats.blocked_ticks = move_counts_[kEventBlocked];
+    stats.max_queue_depth = network_.max_pending();
+    stats.status_evaluations = status_evaluations_;
+    stats.network_s = network_s_;
+    stats.moves_s = moves_s_;
+    if (workload_) {
+        stats.messages_arrived = workload_->arrived();
+    }
+    return stats;
+}
+
+int64_t run_scenario(const Config& cfg, Rng& rng, Stats* stats) {
+    if (cfg.shards > 0) {
+        return run_sharded(cfg, rng, stats);
+    }
+    if (fixed_kernel(cfg) != 0) {
+        return run_fixed(cfg, rng, stats);
+    }
+    Scenario scenario(cfg, rng, stats != nullptr);
+    const std::string& checkpoint = cfg.checkpoint_path;
+    if (!checkpoint.empty() && checkpoint_exists(checkpoint)) {
+        scenario.restore(checkpoint);
+    }
+    while (scenario.step()) {
+        const bool due = cfg.checkpoint_every > 0 && scenario.iterations() % cfg.checkpoint_every == 0;
+        if (!checkpoint.empty() && due) {
+            scenario.save(checkpoint);
+        }
+    }
+    if (!checkpoint.empty()) {
+        std::remove(checkpoint.c_str());
+    }
+    if (stats != nullptr) {
+        *stats = scenario.stats();
+    }
+    return scenario.waste();
+}
+
+std::vector<BatchOutcome> run_batch(const Config& cfg, std::vector<Rng>& rngs, bool with_stats) {
+    std::vector<BatchOutcome> outcomes(rngs.size());
+    for (size_t i = 0; i < rngs.size(); ++i) {
+        try {
+            outcomes[i].waste = run_scenario(cfg, rngs[i], with_stats ? &outcomes[i].stats : nullptr);
+        } catch (const SecurityFailure& failure) {
+            outcomes[i].reused_index = failure.index;
+        }
+    }
+    return outcomes;
+}
+
+}  // namespace ringsim
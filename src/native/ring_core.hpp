@@ -0,0 +1,424 @@
+// Native simulation core for the cooperative OTP ring.
+//
+// Mirrors AsynchronousNetwork, PartyState and the Data/Drift/Yield move loop
+// of src/ring_sim.py. Python reaches it through the C API in ring_capi.cpp.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "burned_pads.hpp"
+#include "delays.hpp"
+#include "profile.hpp"
+#include "traffic.hpp"
+
+namespace ringsim {
+
+class CheckpointReader;
+class CheckpointWriter;
+
+// One telemetry record (EVENT in src/telemetry.py, ringsim_event in the C API).
+struct Event {
+    int64_t tick;
+    int64_t index;
+    int32_t queue_depth;
+    int32_t party;
+    uint8_t move;
+    uint8_t padding[7];
+};
+static_assert(sizeof(Event) == 32, "telemetry events are 32 bytes");
+
+enum EventMove : uint8_t { kEventData = 0, kEventDrift = 1, kEventYield = 2, kEventBlocked = 3 };
+
+// Preallocated event buffer handed to the sink whenever it fills and on
+// flush(). Disabled (no sink or no capacity), record() is never reached:
+// callers test enabled() first.
+class Telemetry {
+public:
+    using Sink = void (*)(void* ctx, const Event* events, int64_t count);
+
+    Telemetry(Sink sink, void* ctx, int64_t capacity)
+        : sink_(capacity > 0 ? sink : nullptr), ctx_(ctx), events_(sink_ ? capacity : 0) {}
+
+    bool enabled() const { return sink_ != nullptr; }
+    void record(int64_t tick, int64_t party, uint8_t move, int64_t index, int64_t queue_depth) {
+        events_[used_++] =
+            Event{tick, index, static_cast<int32_t>(queue_depth), static_cast<int32_t>(party), move, {}};
+        if (used_ == events_.size()) {
+            flush();
+        }
+    }
+    void flush() {
+        if (used_ > 0) {
+            sink_(ctx_, events_.data(), static_cast<int64_t>(used_));
+            used_ = 0;
+        }
+    }
+
+private:
+    Sink sink_;
+    void* ctx_;
+    std::vector<Event> events_;
+    size_t used_ = 0;
+};
+
+struct Config {
+    int64_t n;
+    int64_t m;
+    int64_t d;
+    int64_t x;
+    uint64_t rng_state;
+    uint64_t rng_inc;
+    bool coalesce = false;
+    bool skip_drift = false;
+    bool incremental = false;
+    bool event_driven = false;
+    bool neighbor_only = false;
+    bool batch = false;
+    // Sharded schedule: threads, one per arc of parties (see sharded.hpp); 0 otherwise
+    int64_t shards = 0;
+    // m in {2, 3, 4, 8} on the kernels of fixed_ring.hpp where they apply
+    bool fixed_kernels = false;
+    bool mapped_bitmap = false;  // burned bitset in a memory-mapped file
+    bool intervals = false;      // burned pads as BurnedIntervals instead
+    // Worst delivery delay the links show, < 0 for d; see run_scenario in ring_sim.py
+    int64_t link_delay = -1;
+    // Delay model other than uniform, see DelayModel: CDF tables of
+    // delay_cdf_width thresholds per row, or else a trace file
+    std::vector<uint64_t> delay_cdf{};
+    int64_t delay_cdf_width = -1;  // < 0: no tables
+    std::string delay_trace{};
+    bool adaptive = false;  // per-party gap thresholds from observed delays
+    // Workload replacing the x saturated senders, see Workload: one process
+    // per party or else a message trace, arrivals after traffic_until >= 0
+    // dropped, latencies of sent messages passed to the latency sink
+    bool traffic = false;
+    std::vector<Arrivals> arrivals{};
+    std::string message_trace{};
+    int64_t traffic_until = -1;
+    Workload::Sink latency = nullptr;
+    void* latency_ctx = nullptr;
+    // Optional event sink, see Telemetry
+    Telemetry::Sink telemetry = nullptr;
+    void* telemetry_ctx = nullptr;
+    int64_t telemetry_capacity = 0;
+    // Optional phase profiler, owned by the caller (see profile.hpp)
+    Profiler* profiler = nullptr;
+    // Snapshot file for run_scenario; empty to disable checkpoints
+    std::string checkpoint_path{};
+    int64_t checkpoint_every = 0;  // iterations between snapshots
+};
+
+// Raised when a Data move would reuse a burned pad (the Python 'Loud Fail').
+class SecurityFailure : public std::runtime_error {
+public:
+    explicit SecurityFailure(int64_t index)
+        : std::runtime_error("CRITICAL SECURITY FAILURE: pad index reused"), index(index) {}
+    int64_t index;
+};
+
+// PCG-XSH-RR 64/32 with the bounded draws of src/rng.py's Pcg32, so that a
+// given generator state yields the same choices on both backends.
+class Rng {
+public:
+    Rng(uint64_t state, uint64_t inc) : state(state), inc(inc) {}
+    // The generator Pcg32(seed, stream) of src/rng.py (pcg32_srandom_r)
+    static Rng seeded(uint64_t seed, uint64_t stream) {
+        Rng rng(0, (stream << 1) | 1);
+        rng.next32();
+        rng.state += seed;
+        rng.next32();
+        return rng;
+    }
+
+    uint32_t next32() {
+        const uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        const uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        const uint32_t rot = static_cast<uint32_t>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // k <= 64 random bits, least significant 32-bit word first.
+    uint64_t getrandbits(int k);
+
+    // Uniform integer in [0, bound) by rejection on the bit length of bound.
+    uint64_t below(uint64_t bound);
+    int64_t randint(int64_t a, int64_t b) { return a + static_cast<int64_t>(below(b - a + 1)); }
+    // Uniform double in [0, 1) from 53 bits, as random.random()
+    double random() {
+        const uint32_t a = next32() >> 5;
+        const uint32_t b = next32() >> 6;
+        return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
+    }
+
+    uint64_t state;
+    uint64_t inc;
+};
+
+struct Message {
+    int64_t delivery_time;
+    int64_t sender_id;
+    int64_t index;
+    int64_t sent_time;
+};
+
+constexpr int64_t kAdaptivePercentile = 99;  // ADAPTIVE_PERCENTILE in ring_sim.py
+constexpr int64_t kAdaptiveWindow = 1024;    // ADAPTIVE_WINDOW in ring_sim.py
+constexpr int64_t kAdaptiveMinSamples = 100; // ADAPTIVE_MIN_SAMPLES in ring_sim.py
+
+// Running high-percentile delay estimate over a histogram of [0, cap],
+// halved every kAdaptiveWindow samples (DelayEstimator in ring_sim.py).
+class DelayEstimator {
+public:
+    explicit DelayEstimator(int64_t cap) : counts_(static_cast<size_t>(cap) + 1, 0) {}
+
+    // Records one delay; returns the updated estimate.
+    int64_t add(int64_t delay);
+    int64_t estimate() const { return estimate_; }
+    int64_t total() const { return total_; }
+
+private:
+    std::vector<int64_t> counts_;
+    int64_t total_ = 0;
+    int64_t estimate_ = 0;
+    int64_t covered_ = 0;  // samples <= estimate_
+    int64_t since_decay_ = 0;
+};
+
+// Structure-of-arrays state of all m parties: a flat m x m view matrix
+// (row = receiver, column = sender) plus contiguous positions and pad counts.
+// Entries stay int64 so rings beyond 2^31 pads need no separate layout.
+// thresholds and reserve follow PartyState in ring_sim.py: every threshold
+// is d unless track_delays() enables the adaptive mode.
+class PartyState {
+public:
+    PartyState(int64_t n, int64_t m, int64_t d);
+
+    int64_t view(int64_t receiver_id, int64_t sender_id) const {
+        return views[(receiver_id - 1) * m + sender_id - 1];
+    }
+    // Writes index into the sender's column for every party but the sender
+    void broadcast_update(int64_t sender_id, int64_t index);
+    // Writes index into the view of the sender's ring predecessor only
+    void neighbor_update(int64_t sender_id, int64_t index) {
+        const int64_t predecessor = (sender_id + m - 2) % m + 1;
+        views[(predecessor - 1) * m + sender_id - 1] = index;
+    }
+    void track_delays(int64_t cap) { estimators.assign(static_cast<size_t>(m), DelayEstimator(cap)); }
+    bool tracks_delays() const { return !estimators.empty(); }
+    // Feeds the delay of an update from sender_id to its ring predecessor
+    void observe_delay(int64_t sender_id, int64_t delay);
+
+    int64_t n, m, d;
+    std::vector<int64_t> views;
+    std::vector<int64_t> my_index;    // indexed by party_id - 1
+    std::vector<int64_t> pads_used;   // indexed by party_id - 1
+    std::vector<int64_t> thresholds;  // indexed by party_id - 1
+    int64_t reserve;                  // sum of thresholds
+    std::vector<DelayEstimator> estimators;
+};
+
+// Pending messages are kept in a timing wheel of max_delay + 1 buckets for
+// the delay model's max_delay; a message sits in the bucket of the first
+// tick at which it is due. In
+// coalesce mode a new update supersedes the sender's in-flight updates that
+// are due no earlier than it (latest position wins). With neighbor_only an
+// update is applied to the sender's ring predecessor alone.
+class AsynchronousNetwork {
+public:
+    AsynchronousNetwork(DelayModel delays, int64_t m, bool coalesce = false, bool neighbor_only = false)
+        : d_delay_(delays.max_delay()),
+          delays_(std::move(delays)),
+          coalesce_(coalesce),
+          neighbor_only_(neighbor_only),
+          wheel_(d_delay_ + 1),
+          inflight_(coalesce ? m : 0) {}
+
+    void send_broadcast(int64_t sender_id, int64_t new_index, Rng& rng);
+    // Applies the updates due at the new time; the sender of each applied
+    // update is appended to updated_senders when given.
+    // Reports each update's delay through parties.observe_delay when the
+    // parties track delays.
+    bool tick(PartyState& parties, std::vector<int64_t>* updated_senders = nullptr);
+    bool empty() const { return pending_ == 0; }
+    // Moves the clock to just before the next tick with a due update;
+    // returns the number of ticks skipped.
+    int64_t skip_idle();
+    int64_t pending() const { return pending_; }
+    int64_t superseded() const { return superseded_; }
+    int64_t sent() const { return sent_; }
+    int64_t delivered() const { return delivered_; }
+    // Per-party view writes, i.e. point-to-point messages
+    int64_t view_updates() const { return view_updates_; }
+    int64_t max_pending() const { return max_pending_; }
+    int64_t d_delay() const { return d_delay_; }
+    // Clock, counters and in-flight updates, for checkpoints
+    void save(CheckpointWriter& out) const;
+    void load(CheckpointReader& in, int64_t m);
+
+    int64_t current_time = 0;
+
+private:
+    std::vector<Message>& bucket(int64_t time) {
+        return wheel_[static_cast<size_t>(time % static_cast<int64_t>(wheel_.size()))];
+    }
+
+    void supersede(int64_t sender_id, int64_t due);
+
+    int64_t d_delay_;
+    DelayModel delays_;
+    bool coalesce_;
+    bool neighbor_only_;
+    int64_t pending_ = 0;
+    int64_t sent_ = 0;
+    int64_t delivered_ = 0;
+    int64_t superseded_ = 0;
+    int64_t view_updates_ = 0;
+    int64_t max_pending_ = 0;
+    std::vector<std::vector<Message>> wheel_;
+    std::vector<std::deque<int64_t>> inflight_;  // per sender: ascending due ticks
+};
+
+enum class Move { Blocked, Data, Drift };
+
+// Counters of one run (ScenarioStats in ring_sim.py).
+struct Stats {
+    int64_t ticks = 0;
+    int64_t iterations = 0;
+    int64_t broadcasts = 0;
+    int64_t delivered = 0;
+    int64_t view_updates = 0;
+    int64_t data_moves = 0;
+    int64_t drift_moves = 0;
+    int64_t yield_moves = 0;
+    int64_t blocked_ticks = 0;
+    int64_t max_queue_depth = 0;
+    int64_t status_evaluations = 0;
+    double network_s = 0.0;  // wall time delivering updates
+    double moves_s = 0.0;    // wall time selecting and applying moves
+    int64_t messages_arrived = 0;  // workload runs only
+};
+
+// Party ids that can currently move: a dense array with swap-remove, so
+// updates and uniform selection are O(1) (see LegalMovers in ring_sim.py).
+class LegalMovers {
+public:
+    explicit LegalMovers(int64_t m) : slot_(m + 1, -1) {}
+
+    void update(int64_t p_id, bool legal) {
+        const int64_t slot = slot_[p_id];
+        if (legal && slot < 0) {
+            slot_[p_id] = static_cast<int64_t>(ids.size());
+            ids.push_back(p_id);
+        } else if (!legal && slot >= 0) {
+            const int64_t last = ids.back();
+            ids.pop_back();
+            slot_[p_id] = -1;
+            if (last != p_id) {
+                ids[slot] = last;
+                slot_[last] = slot;
+            }
+        }
+    }
+
+    std::vector<int64_t> ids;
+
+private:
+    std::vector<int64_t> slot_;
+};
+
+// One run of the Data/Drift/Yield loop, advanced one iteration at a time.
+// rng is drawn from as the scenario proceeds and must outlive it.
+class Scenario {
+public:
+    // timed: measure the wall-time split reported in stats()
+    Scenario(const Config& cfg, Rng& rng, bool timed = false);
+
+    // Runs one loop iteration; returns false once the scenario has ended.
+    // Throws SecurityFailure if a pad would be encrypted twice.
+    bool step();
+    bool done() const { return done_; }
+    int64_t iterations() const { return iterations_; }
+    int64_t waste() const { return cfg_.n - burned_.size(); }
+    Stats stats() const;
+
+    // Writes a snapshot of the complete scenario and generator state to path
+    // (through a temporary file, so an existing snapshot is replaced
+    // atomically). restore() loads one written for the same configuration;
+    // the scenario then continues exactly as the saved one would have.
+    // Both throw CheckpointError.
+    void save(const std::string& path) const;
+    void restore(const std::string& path);
+
+private:
+    Move move_status(int64_t p_id, int64_t& next_idx) const;
+    int64_t skip_target(int64_t p_id) const;
+    void refresh(int64_t p_id);
+    const std::vector<int64_t>& legal_movers(bool active);
+    void move(int64_t p_id, Move status, int64_t nxt);
+    bool move_single();
+    bool move_batch();
+    void arrive();
+
+    Config cfg_;
+    Rng& rng_;
+    AsynchronousNetwork network_;
+    std::vector<int64_t> all_ids_, active_ids_, silent_ids_;
+    std::vector<char> is_active_;  // with a workload: the party has queued messages
+    PartyState parties_;
+    BurnedPads burned_;
+    int64_t max_utilization_;
+    LegalMovers legal_active_, legal_silent_;
+    std::vector<int64_t> updated_senders_;
+    std::vector<int64_t> scanned_;   // legal movers of a group, scan mode
+    std::vector<int64_t> rotation_;  // batch schedule: this tick's movers
+    std::unordered_set<int64_t> claimed_;  // batch schedule: next indices taken
+    std::unique_ptr<Workload> workload_;
+    std::vector<int64_t> became_busy_;
+    Telemetry telemetry_;
+    bool timed_;
+    int64_t iterations_ = 0;
+    int64_t move_counts_[4] = {0, 0, 0, 0};  // indexed by EventMove
+    mutable int64_t status_evaluations_ = 0;
+    double network_s_ = 0.0, moves_s_ = 0.0;
+    bool done_ = false;
+};
+
+// The delay model a configuration selects.
+DelayModel delay_model(const Config& cfg);
+
+// Partial Fisher-Yates, matching the pool branch of Python's random.sample.
+std::vector<int64_t> sample(std::vector<int64_t> pool, int64_t k, Rng& rng);
+
+// Runs one scenario and returns the count of unused pads. rng starts from
+// the configured state and is left where the scenario stopped drawing;
+// stats, when given, receives the run counters. With a checkpoint path the
+// run resumes from an existing snapshot there, saves one every
+// checkpoint_every iterations and removes it once the scenario ends.
+// Throws SecurityFailure if a pad would be encrypted twice, CheckpointError
+// if a snapshot cannot be read or written. cfg.shards > 0 runs the sharded
+// schedule of sharded.hpp instead, and cfg.fixed_kernels the kernels of
+// fixed_ring.hpp when fixed_kernel(cfg) names one.
+int64_t run_scenario(const Config& cfg, Rng& rng, Stats* stats = nullptr);
+
+// Outcome of one scenario of a batch; reused_index is -1 unless the
+// scenario hit a SecurityFailure, which ends that scenario only.
+struct BatchOutcome {
+    int64_t waste = 0;
+    int64_t reused_index = -1;
+    Stats stats;
+};
+
+// Runs one scenario per rng, one after the other within the call; outcomes
+// and rngs are the same as running each scenario through run_scenario.
+// Outcome stats are only filled (and the runs only timed) with with_stats.
+std::vector<BatchOutcome> run_batch(const Config& cfg, std::vector<Rng>& rngs, bool with_stats);
+
+}  // namespace ringsim
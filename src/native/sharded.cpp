@@ -0,0 +1,471 @@
+#include "sharded.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "pad_allocator.hpp"
+
+namespace ringsim {
+
+namespace {
+
+constexpr int64_t kNever = std::numeric_limits<int64_t>::max();
+
+// A position update on its way to the sender's ring predecessor
+struct Update {
+    int64_t due;
+    int64_t sender;
+    int64_t index;
+    int64_t sent;
+};
+
+struct Shard {
+    Shard(int64_t lo, int64_t hi, Rng rng, int64_t slots, int64_t window)
+        : lo(lo),
+          hi(hi),
+          rng(rng),
+          wheel(static_cast<size_t>(slots)),
+          outbox(static_cast<size_t>(2 * window)),
+          moved(static_cast<size_t>(window)),
+          delivered(static_cast<size_t>(window)),
+          evaluations(static_cast<size_t>(window)),
+          held(static_cast<size_t>(window)) {}
+
+    int64_t lo, hi;  // first and last party
+    Rng rng;
+    std::vector<std::vector<Update>> wheel;  // updates to this shard's parties, by due tick
+    int64_t queued = 0;                      // updates in the wheel
+    int64_t applied = 0;                     // updates written into a view
+    // Updates from the first party to the previous shard: at most one per
+    // tick of this window and of the one before
+    SpscQueue<Update> outbox;
+    size_t marks[2] = {0, 0};  // outbox.pushed() at the end of the last two windows
+    int64_t sent = 0;          // pushed this window
+    int64_t next_due = kNever; // earliest due pushed this window
+    std::vector<int64_t> movers;
+    // Per tick of the current window
+    std::vector<uint8_t> moved;
+    std::vector<int64_t> delivered, evaluations, held;
+    int64_t burned = 0;                  // pads burned by Data moves
+    int64_t moves[3] = {0, 0, 0};        // indexed by EventMove
+    int64_t reused = -1;
+};
+
+class ShardedRun {
+public:
+    ShardedRun(const Config& cfg, Rng& rng);
+    int64_t run(Stats* stats);
+
+private:
+    Move move_status(int64_t p_id, int64_t& next_idx, int64_t& evaluations) const;
+    int64_t skip_target(int64_t p_id) const;
+    int64_t deliver(Shard& shard, int64_t now);
+    // limited: stop handing out moves at max_utilization (serial ticks)
+    bool move_shard(Shard& shard, int64_t now, bool limited, int64_t& evaluations);
+    void move(Shard& shard, int64_t p_id, Move status, int64_t nxt, int64_t now, bool limited);
+    void drain(Shard& shard, size_t mark);
+    void run_window(size_t s);
+    void close_window();
+    void run_serial();
+    int64_t next_due() const;
+    // One-tick windows would cost two barriers a tick for a tick of work each
+    bool parallel() const { return window_ > 1 && max_utilization_ - burned_ > cfg_.x * window_; }
+    int64_t pending() const;
+
+    const Config& cfg_;
+    DelayModel delays_;
+    int64_t n_, m_, slots_, window_;
+    int64_t max_utilization_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<int64_t> shard_of_;   // indexed by party id
+    std::vector<char> is_active_;     // indexed by party id
+    std::vector<int64_t> pos_, front_view_, pads_used_;  // indexed by party id
+    std::vector<int64_t> view_sent_;  // send tick of each front view, indexed by party id
+    AtomicBitset burned_pads_;
+    int64_t burned_ = 0, initial_burned_ = 0;
+    // Clock and counters, owned by the coordinating thread
+    int64_t now_ = 0, windows_ = 0;
+    int64_t iterations_ = 0, delivered_ = 0, blocked_ = 0, max_depth_ = 0, evaluations_ = 0;
+    bool last_moved_ = true;  // the last counted tick moved a party
+    bool stop_ = false;   // the run has ended
+    bool leave_ = false;  // the parallel phase has ended
+};
+
+ShardedRun::ShardedRun(const Config& cfg, Rng& rng)
+    : cfg_(cfg),
+      delays_(delay_model(cfg)),
+      n_(cfg.n),
+      m_(cfg.m),
+      slots_(delays_.max_delay() + 1),
+      window_(std::max<int64_t>(1, delays_.least_delay())),
+      max_utilization_(cfg.n - cfg.m * cfg.d),
+      shard_of_(cfg.m + 1),
+      is_active_(cfg.m + 1, 0),
+      pos_(cfg.m + 1),
+      front_view_(cfg.m + 1),
+      pads_used_(cfg.m + 1, 0),
+      view_sent_(cfg.m + 1, -1),
+      burned_pads_(cfg.n) {
+    std::vector<int64_t> all_ids(m_);
+    for (int64_t i = 0; i < m_; ++i) {
+        all_ids[i] = i + 1;
+        pos_[i + 1] = i * (n_ / m_);
+    }
+    for (int64_t pid = 1; pid <= m_; ++pid) {
+        front_view_[pid] = pos_[pid % m_ + 1];
+    }
+    for (int64_t pid : sample(all_ids, cfg_.x, rng)) {
+        is_active_[pid] = 1;
+        initial_burned_ += burned_pads_.claim(pos_[pid]) ? 1 : 0;
+    }
+    burned_ = initial_burned_;
+    for (int64_t s = 0; s < cfg_.shards; ++s) {
+        const int64_t lo = 1 + s * m_ / cfg_.shards, hi = (s + 1) * m_ / cfg_.shards;
+        shards_.push_back(std::make_unique<Shard>(lo, hi, Rng::seeded(rng.getrandbits(64), s), slots_, window_));
+        std::fill(shard_of_.begin() + lo, shard_of_.begin() + hi + 1, s);
+    }
+    // x == 0 ends the run at once; see run_scenario in src/ring_sim.py
+    stop_ = cfg_.x == 0;
+}
+
+Move ShardedRun::move_status(int64_t p_id, int64_t& next_idx, int64_t& evaluations) const {
+    evaluations += 1;
+    const int64_t pos = pos_[p_id];
+    int64_t gap = front_view_[p_id] - pos;
+    if (gap < 0) {
+        gap += n_;
+    }
+    next_idx = pos + 1 == n_ ? 0 : pos + 1;
+    if (gap > cfg_.d) {
+        return burned_pads_.contains(next_idx) ? Move::Drift : Move::Data;
+    }
+    return Move::Blocked;
+}
+
+// As Scenario::skip_target. The pads up to the target lie before the front
+// neighbour's reported position, so no other thread writes them meanwhile
+int64_t ShardedRun::skip_target(int64_t p_id) const {
+    const int64_t pos = pos_[p_id];
+    int64_t gap = front_view_[p_id] - pos;
+    if (gap < 0) {
+        gap += n_;
+    }
+    const int64_t fresh = burned_pads_.next_unset(pos + 1 == n_ ? 0 : pos + 1, n_);
+    int64_t run = n_;
+    if (fresh >= 0) {
+        run = fresh - 1 - pos;
+        if (run < 0) {
+            run += n_;
+        }
+    }
+    return (pos + std::min(run, gap - cfg_.d)) % n_;
+}
+
+int64_t ShardedRun::deliver(Shard& shard, int64_t now) {
+    std::vector<Update>& due = shard.wheel[static_cast<size_t>(now % slots_)];
+    for (const Update& update : due) {
+        // A view never goes back to an older position, see drop_stale in ring_sim.py
+        const int64_t reader = (update.sender + m_ - 2) % m_ + 1;
+        if (update.sent > view_sent_[reader]) {
+            front_view_[reader] = update.index;
+            view_sent_[reader] = update.sent;
+            shard.applied += 1;
+        }
+    }
+    const int64_t count = static_cast<int64_t>(due.size());
+    shard.queued -= count;
+    due.clear();
+    return count;
+}
+
+void ShardedRun::move(Shard& shard, int64_t p_id, Move status, int64_t nxt, int64_t now, bool limited) {
+    uint8_t event = kEventYield;
+    if (is_active_[p_id]) {
+        event = status == Move::Data ? kEventData : kEventDrift;
+        if (status == Move::Drift && cfg_.skip_drift) {
+            nxt = skip_target(p_id);
+        }
+        if (status == Move::Data) {
+            if (!burned_pads_.claim(nxt)) {
+                if (limited) {
+                    throw SecurityFailure(nxt);
+                }
+                shard.reused = nxt;  // raised by the coordinator after the window
+            }
+            pads_used_[p_id] += 1;
+            shard.burned += 1;
+            if (limited) {
+                burned_ += 1;
+            }
+        }
+    }
+    pos_[p_id] = nxt;
+    shard.moves[event] += 1;
+    const int64_t delay = delays_.is_uniform() ? shard.rng.randint(0, delays_.max_delay())
+                                               : delays_.draw(p_id, shard.rng);
+    const Update update{now + std::max<int64_t>(1, delay), p_id, nxt, now};
+    const int64_t reader = (p_id + m_ - 2) % m_ + 1;
+    if (reader >= shard.lo && reader <= shard.hi) {
+        shard.wheel[static_cast<size_t>(update.due % slots_)].push_back(update);
+        shard.queued += 1;
+    } else if (limited) {
+        // Serial ticks write straight into the receiving shard
+        Shard& target = *shards_[static_cast<size_t>(shard_of_[reader])];
+        target.wheel[static_cast<size_t>(update.due % slots_)].push_back(update);
+        target.queued += 1;
+    } else {
+        if (!shard.outbox.push(update)) {
+            throw std::logic_error("sharded run: boundary queue overflow");
+        }
+        shard.sent += 1;
+        shard.next_due = std::min(shard.next_due, update.due);
+    }
+}
+
+bool ShardedRun::move_shard(Shard& shard, int64_t now, bool limited, int64_t& evaluations) {
+    shard.movers.clear();
+    int64_t nxt;
+    for (int64_t pid = shard.lo; pid <= shard.hi; ++pid) {
+        if (move_status(pid, nxt, evaluations) != Move::Blocked) {
+            shard.movers.push_back(pid);
+        }
+    }
+    if (shard.movers.empty()) {
+        return false;
+    }
+    const size_t start = shard.rng.below(shard.movers.size());
+    std::rotate(shard.movers.begin(), shard.movers.begin() + static_cast<std::ptrdiff_t>(start), shard.movers.end());
+    for (int64_t pid : shard.movers) {
+        if (limited && burned_ >= max_utilization_) {
+            break;
+        }
+        const Move status = move_status(pid, nxt, evaluations);
+        move(shard, pid, status, nxt, now, limited);
+    }
+    return true;
+}
+
+// Moves the updates the next shard sent up to mark into shard's wheel
+void ShardedRun::drain(Shard& shard, size_t mark) {
+    SpscQueue<Update>& inbox = shards_[(static_cast<size_t>(shard_of_[shard.lo]) + 1) % shards_.size()]->outbox;
+    Update update;
+    while (inbox.popped() < mark && inbox.pop(update)) {
+        shard.wheel[static_cast<size_t>(update.due % slots_)].push_back(update);
+        shard.queued += 1;
+    }
+}
+
+// One window of shard s, run by its own thread
+void ShardedRun::run_window(size_t s) {
+    Shard& shard = *shards_[s];
+    const Shard& next = *shards_[(s + 1) % shards_.size()];
+    drain(shard, next.marks[(windows_ + 1) & 1]);
+    shard.sent = 0;
+    shard.next_due = kNever;
+    for (int64_t i = 0; i < window_; ++i) {
+        const int64_t now = now_ + 1 + i;
+        shard.evaluations[i] = 0;
+        shard.delivered[i] = deliver(shard, now);
+        // The window only runs in parallel while no shard can reach max_utilization
+        shard.moved[i] = move_shard(shard, now, false, shard.evaluations[i]);
+        shard.held[i] = shard.queued + shard.sent;
+    }
+    shard.marks[windows_ & 1] = shard.outbox.pushed();
+}
+
+// Counts the window's ticks as the tick-by-tick loop would; coordinator only
+void ShardedRun::close_window() {
+    int64_t end = now_ + window_, depth = 0;
+    for (int64_t i = 0; i < window_; ++i) {
+        bool moved = false;
+        int64_t delivered = 0, evaluations = 0;
+        depth = 0;
+        for (const auto& shard : shards_) {
+            moved = moved || shard->moved[i];
+            delivered += shard->delivered[i];
+            evaluations += shard->evaluations[i];
+            depth += shard->held[i];
+        }
+        delivered_ += delivered;
+        // Event-driven runs jump over the ticks after a blocked one until the next delivery
+        if (cfg_.event_driven && !last_moved_ && delivered == 0) {
+            continue;
+        }
+        iterations_ += 1;
+        evaluations_ += evaluations;
+        max_depth_ = std::max(max_depth_, depth);
+        last_moved_ = moved;
+        if (!moved) {
+            blocked_ += 1;
+            if (depth == 0) {
+                end = now_ + 1 + i;
+                stop_ = true;
+                break;
+            }
+        }
+    }
+    now_ = end;
+    windows_ += 1;
+    burned_ = initial_burned_;
+    for (const auto& shard : shards_) {
+        burned_ += shard->burned;
+        if (shard->reused >= 0) {
+            throw SecurityFailure(shard->reused);
+        }
+    }
+    if (!stop_ && cfg_.event_driven && !last_moved_ && depth > 0) {
+        now_ = std::max(now_, next_due() - 1);
+    }
+}
+
+// Earliest due tick of any update in flight
+int64_t ShardedRun::next_due() const {
+    int64_t due = kNever;
+    for (const auto& shard : shards_) {
+        due = std::min(due, shard->next_due);
+        for (int64_t ahead = 1; ahead <= slots_ && now_ + ahead < due; ++ahead) {
+            if (!shard->wheel[static_cast<size_t>((now_ + ahead) % slots_)].empty()) {
+                due = now_ + ahead;
+                break;
+            }
+        }
+    }
+    return due;
+}
+
+int64_t ShardedRun::pending() const {
+    int64_t queued = 0;
+    for (const auto& shard : shards_) {
+        queued += shard->queued;
+    }
+    return queued;
+}
+
+// The loop of run_scenario over all shards on this thread, one tick at a time
+void ShardedRun::run_serial() {
+    for (const auto& shard : shards_) {
+        drain(*shard, std::numeric_limits<size_t>::max());
+        shard->next_due = kNever;
+    }
+    while (!stop_ && burned_ < max_utilization_) {
+        now_ += 1;
+        iterations_ += 1;
+        for (const auto& shard : shards_) {
+            delivered_ += deliver(*shard, now_);
+        }
+        bool moved = false;
+        for (const auto& shard : shards_) {
+            if (burned_ >= max_utilization_) {
+                break;
+            }
+            moved = move_shard(*shard, now_, true, evaluations_) || moved;
+        }
+        const int64_t depth = pending();
+        max_depth_ = std::max(max_depth_, depth);
+        if (!moved) {
+            blocked_ += 1;
+            if (depth == 0) {
+                break;
+            }
+            if (cfg_.event_driven) {
+                now_ = next_due() - 1;
+            }
+        }
+    }
+}
+
+int64_t ShardedRun::run(Stats* stats) {
+    const size_t threads = shards_.size();
+    if (!stop_ && burned_ < max_utilization_ && parallel()) {
+        SpinBarrier barrier(static_cast<int64_t>(threads));
+        std::atomic<int> gate{0};  // 1 once every thread started, 2 to abort
+        std::exception_ptr failure;
+        auto loop = [&](size_t s) {
+            for (;;) {
+                run_window(s);
+                barrier.wait();
+                if (s == 0) {
+                    try {
+                        close_window();
+                        leave_ = stop_ || !parallel();
+                    } catch (...) {
+                        failure = std::current_exception();
+                        leave_ = true;
+                    }
+                }
+                barrier.wait();
+                if (leave_) {
+                    return;
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        try {
+            for (size_t s = 1; s < threads; ++s) {
+                pool.emplace_back([&, s] {
+                    while (gate.load(std::memory_order_acquire) == 0) {
+                        std::this_thread::yield();
+                    }
+                    if (gate.load(std::memory_order_acquire) == 1) {
+                        loop(s);
+                    }
+                });
+            }
+        } catch (...) {
+            gate.store(2, std::memory_order_release);
+            for (std::thread& thread : pool) {
+                thread.join();
+            }
+            throw;
+        }
+        gate.store(1, std::memory_order_release);
+        loop(0);
+        for (std::thread& thread : pool) {
+            thread.join();
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+    run_serial();
+
+    if (stats != nullptr) {
+        Stats out;
+        out.ticks = now_;
+        out.iterations = iterations_;
+        out.delivered = delivered_;
+        for (const auto& shard : shards_) {
+            out.view_updates += shard->applied;
+            out.data_moves += shard->moves[kEventData];
+            out.drift_moves += shard->moves[kEventDrift];
+            out.yield_moves += shard->moves[kEventYield];
+        }
+        out.broadcasts = out.data_moves + out.drift_moves + out.yield_moves;
+        out.blocked_ticks = blocked_;
+        out.max_queue_depth = max_depth_;
+        out.status_evaluations = evaluations_;
+        *stats = out;
+    }
+    return n_ - burned_;
+}
+
+}  // namespace
+
+int64_t run_sharded(const Config& cfg, Rng& rng, Stats* stats) {
+    if (cfg.shards < 1 || cfg.shards > cfg.m || cfg.d < 1) {
+        throw std::invalid_argument("the sharded schedule needs 1 <= shards <= m and d >= 1");
+    }
+    if (cfg.coalesce || cfg.incremental || cfg.adaptive || cfg.traffic || cfg.telemetry != nullptr ||
+        cfg.profiler != nullptr || !cfg.checkpoint_path.empty() || !cfg.delay_trace.empty()) {
+        throw std::invalid_argument(
+            "sharded runs take no coalescing, incremental movers, adaptive thresholds, workload, "
+            "telemetry, profile, checkpoint or delay trace");
+    }
+    ShardedRun run(cfg, rng);
+    return run.run(stats);
+}
+
+}  // namespace ringsim
@@ -0,0 +1,109 @@
+// Sharded schedule of run_scenario (schedule='sharded' in src/ring_sim.py).
+//
+// The parties are split into contiguous arcs, one shard and one thread per
+// arc. A shard owns its parties' positions and views of their front
+// neighbours, its own generator and a timing wheel for the updates its
+// parties receive. Updates only ever go to the sender's ring predecessor, so
+// the first party of an arc is the only one that talks to another shard:
+// its updates travel through a bounded SPSC queue to the previous shard.
+//
+// Shards advance in windows of W ticks, W the least delay the delay model
+// can draw (at least 1). An update sent in a window is never due before the
+// next window starts, so shards only hand over their queued updates at the
+// barrier between windows. Stale updates are dropped, so views never move
+// back and no party passes its front neighbour. A party then reads nothing
+// but its own view and the pads up to that view, which no other party
+// writes meanwhile (d >= 1), so a window's outcome does not depend on
+// thread timing.
+// Windows in which the shards could burn the last pads before n - m*d run
+// on one thread, shard after shard, tick by tick, so the run stops at the
+// same move as the Python backend.
+// With W = 1 (the default uniform delays draw 0) the whole run takes that
+// one-thread path: a barrier pair per tick costs more than a tick's work.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "ring_core.hpp"
+
+namespace ringsim {
+
+// Bounded single-producer single-consumer queue over a power-of-two ring.
+// head and tail count every pop and push, so pushed() doubles as a mark the
+// consumer can drain up to.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        buffer_.reset(new T[size]);
+        mask_ = size - 1;
+    }
+
+    // Producer side; returns false when the queue is full.
+    bool push(const T& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_) {
+            return false;
+        }
+        buffer_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    // Consumer side; returns false when the queue is empty.
+    bool pop(T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = buffer_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    size_t pushed() const { return tail_.load(std::memory_order_acquire); }
+    size_t popped() const { return head_.load(std::memory_order_acquire); }
+
+private:
+    std::unique_ptr<T[]> buffer_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+// Reusable barrier for a fixed number of threads. The last thread to arrive
+// opens the next generation; the others spin on it, yielding the core.
+class SpinBarrier {
+public:
+    explicit SpinBarrier(int64_t threads) : threads_(threads) {}
+
+    void wait() {
+        const uint64_t generation = generation_.load(std::memory_order_acquire);
+        if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == threads_) {
+            arrived_.store(0, std::memory_order_relaxed);
+            generation_.store(generation + 1, std::memory_order_release);
+            return;
+        }
+        while (generation_.load(std::memory_order_acquire) == generation) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    const int64_t threads_;
+    alignas(64) std::atomic<int64_t> arrived_{0};
+    alignas(64) std::atomic<uint64_t> generation_{0};
+};
+
+// Runs one sharded scenario with cfg.shards threads; see run_scenario.
+// Throws std::invalid_argument for an option the schedule does not support
+// and SecurityFailure if a pad would be encrypted twice.
+int64_t run_sharded(const Config& cfg, Rng& rng, Stats* stats);
+
+}  // namespace ringsim
@@ -0,0 +1,185 @@
+#include "traffic.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "ring_core.hpp"
+
+namespace ringsim {
+
+namespace {
+
+constexpr char kTraceMagic[8] = {'R', 'I', 'N', 'G', 'M', 'S', 'G', '1'};
+constexpr long kTraceHeader = 24;        // TRACE_HEADER in src/traffic.py
+constexpr size_t kMessageSize = 12;      // MESSAGE in src/traffic.py
+constexpr uint64_t kTraceChunk = 65536;  // TRACE_CHUNK in src/traffic.py
+constexpr size_t kLatencyChunk = 4096;   // latencies handed to the sink per call
+constexpr int32_t kPoisson = 1;
+constexpr int32_t kOnOff = 2;
+
+double exponential(Rng& rng, double rate) { return -std::log(1.0 - rng.random()) / rate; }
+
+}  // namespace
+
+Workload::Workload(std::vector<Arrivals> arrivals, const std::string& trace, int64_t until, Sink sink, void* ctx)
+    : arrivals_(std::move(arrivals)),
+      processes_(arrivals_.size()),
+      until_(until),
+      queues_(arrivals_.size() + 1),
+      sink_(sink),
+      ctx_(ctx) {
+    const int64_t m = static_cast<int64_t>(arrivals_.size());
+    for (int64_t pid = 1; pid <= m; ++pid) {
+        const Arrivals& process = arrivals_[pid - 1];
+        if (process.kind != 0 && process.kind != kPoisson && process.kind != kOnOff) {
+            throw std::invalid_argument("unknown arrival process kind");
+        }
+        if (process.kind != 0 || !trace.empty()) {
+            senders_.push_back(pid);
+        }
+    }
+    if (trace.empty()) {
+        return;
+    }
+    trace_.reset(std::fopen(trace.c_str(), "rb"));
+    unsigned char header[kTraceHeader];
+    if (!trace_ || std::fread(header, 1, sizeof header, trace_.get()) != sizeof header ||
+        std::memcmp(header, kTraceMagic, sizeof kTraceMagic) != 0) {
+        throw std::invalid_argument("not a message trace: " + trace);
+    }
+    uint32_t parties;
+    std::memcpy(&count_, header + 8, sizeof count_);
+    std::memcpy(&parties, header + 16, sizeof parties);
+    if (parties != static_cast<uint64_t>(m)) {
+        throw std::invalid_argument("message trace for another ring size: " + trace);
+    }
+    path_ = trace;
+}
+
+void Workload::reset(Rng& rng) {
+    for (int64_t pid : senders_) {
+        if (arrivals_[pid - 1].kind != 0) {
+            processes_[pid - 1] = Process{};
+            schedule(pid, next_arrival(pid, rng));
+        }
+    }
+    if (trace_) {
+        std::fseek(trace_.get(), kTraceHeader, SEEK_SET);
+        read_ = 0;
+        chunk_.clear();
+        next_ = 0;
+    }
+}
+
+int64_t Workload::next_arrival(int64_t pid, Rng& rng) {
+    const Arrivals& arrivals = arrivals_[pid - 1];
+    Process& process = processes_[pid - 1];
+    if (arrivals.kind == kPoisson) {
+        process.t += exponential(rng, arrivals.rate);
+        return static_cast<int64_t>(std::ceil(process.t));
+    }
+    for (;;) {
+        if (!process.on) {
+            process.t = process.switch_at;
+            process.on = true;
+            process.switch_at = process.t + exponential(rng, 1.0 / arrivals.mean_on);
+        }
+        const double gap = exponential(rng, arrivals.rate);
+        if (process.t + gap < process.switch_at) {
+            process.t += gap;
+            return static_cast<int64_t>(std::ceil(process.t));
+        }
+        // The on period ends first; gaps are memoryless, so restart after it
+        process.t = process.switch_at;
+        process.on = false;
+        process.switch_at = process.t + exponential(rng, 1.0 / arrivals.mean_off);
+    }
+}
+
+void Workload::schedule(int64_t pid, int64_t tick) {
+    if (until_ < 0 || tick <= until_) {
+        heap_.emplace(tick, pid);
+    }
+}
+
+void Workload::push(int64_t pid, int64_t tick, std::vector<int64_t>& became_busy) {
+    std::deque<int64_t>& queue = queues_[pid];
+    if (queue.empty()) {
+        became_busy.push_back(pid);
+    }
+    queue.push_back(tick);
+    arrived_ += 1;
+    queued_ += 1;
+}
+
+bool Workload::peek(Due& record) {
+    if (next_ == chunk_.size()) {
+        if (read_ == count_) {
+            return false;
+        }
+        const uint64_t records = std::min(kTraceChunk, count_ - read_);
+        std::vector<unsigned char> raw(static_cast<size_t>(records) * kMessageSize);
+        if (std::fread(raw.data(), 1, raw.size(), trace_.get()) != raw.size()) {
+            throw std::invalid_argument("truncated message trace: " + path_);
+        }
+        chunk_.resize(static_cast<size_t>(records));
+        for (size_t i = 0; i < chunk_.size(); ++i) {
+            int64_t tick;
+            int32_t party;
+            std::memcpy(&tick, raw.data() + i * kMessageSize, sizeof tick);
+            std::memcpy(&party, raw.data() + i * kMessageSize + sizeof tick, sizeof party);
+            if (party < 1 || party > static_cast<int64_t>(arrivals_.size())) {
+                throw std::invalid_argument("message trace names an unknown party: " + path_);
+            }
+            chunk_[i] = Due{tick, party};
+        }
+        read_ += records;
+        next_ = 0;
+    }
+    record = chunk_[next_];
+    return true;
+}
+
+void Workload::arrive(int64_t now, Rng& rng, std::vector<int64_t>& became_busy) {
+    while (!heap_.empty() && heap_.top().first <= now) {
+        const Due due = heap_.top();
+        heap_.pop();
+        push(due.second, due.first, became_busy);
+        schedule(due.second, next_arrival(due.second, rng));
+    }
+    Due record;
+    while (trace_ && peek(record) && record.first <= now && (until_ < 0 || record.first <= until_)) {
+        next_ += 1;
+        push(record.second, record.first, became_busy);
+    }
+}
+
+bool Workload::take(int64_t pid, int64_t now) {
+    std::deque<int64_t>& queue = queues_[pid];
+    latencies_.push_back(now - queue.front());
+    queue.pop_front();
+    queued_ -= 1;
+    if (latencies_.size() == kLatencyChunk) {
+        flush();
+    }
+    return queue.empty();
+}
+
+bool Workload::finished() {
+    if (queued_ > 0 || !heap_.empty()) {
+        return false;
+    }
+    Due record;
+    return !trace_ || !peek(record) || (until_ >= 0 && record.first > until_);
+}
+
+void Workload::flush() {
+    if (sink_ != nullptr && !latencies_.empty()) {
+        sink_(ctx_, latencies_.data(), static_cast<int64_t>(latencies_.size()));
+    }
+    latencies_.clear();
+}
+
+}  // namespace ringsim
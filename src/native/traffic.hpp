@@ -0,0 +1,80 @@
+// Workload-driven senders of run_scenario (src/traffic.py).
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ringsim {
+
+class Rng;
+
+// Arrival process of one party; kinds as ringsim_arrivals.kind.
+struct Arrivals {
+    int32_t kind = 0;  // 0 never sends, 1 Poisson, 2 on/off
+    double rate = 0.0;
+    double mean_on = 0.0;
+    double mean_off = 0.0;
+};
+
+// Per-party send queues fed by arrival processes or a message trace
+// (Workload in traffic.py). Processes draw from the run's generator in the
+// same order as the Python backend: first arrivals in party order, then one
+// draw sequence per arrival as the (tick, party) heap is popped. Latencies
+// of sent messages go to the sink in chunks, the last one on flush().
+class Workload {
+public:
+    using Sink = void (*)(void* ctx, const int64_t* latencies, int64_t count);
+
+    // until < 0 keeps every arrival. Throws std::invalid_argument for an
+    // unreadable trace or an unknown process kind.
+    Workload(std::vector<Arrivals> arrivals, const std::string& trace, int64_t until, Sink sink, void* ctx);
+
+    // Parties that may send, ascending
+    const std::vector<int64_t>& senders() const { return senders_; }
+    void reset(Rng& rng);
+    // Queues every message due by tick now; appends parties whose queue filled
+    void arrive(int64_t now, Rng& rng, std::vector<int64_t>& became_busy);
+    // Spends the oldest message of pid; returns true if its queue emptied
+    bool take(int64_t pid, int64_t now);
+    bool finished();
+    void flush();
+    int64_t arrived() const { return arrived_; }
+
+private:
+    struct Process {
+        double t = 0.0, switch_at = 0.0;
+        bool on = false;
+    };
+    using File = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+    using Due = std::pair<int64_t, int64_t>;  // tick, party
+
+    int64_t next_arrival(int64_t pid, Rng& rng);
+    void schedule(int64_t pid, int64_t tick);
+    void push(int64_t pid, int64_t tick, std::vector<int64_t>& became_busy);
+    // Next trace record, false once the trace is exhausted
+    bool peek(Due& record);
+
+    std::vector<Arrivals> arrivals_;
+    std::vector<Process> processes_;
+    std::vector<int64_t> senders_;
+    int64_t until_;
+    std::vector<std::deque<int64_t>> queues_;  // indexed by party id: arrival ticks
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> heap_;
+    int64_t arrived_ = 0, queued_ = 0;
+    File trace_{nullptr, std::fclose};
+    std::string path_;
+    uint64_t count_ = 0, read_ = 0;  // records in the trace, records read
+    std::vector<Due> chunk_;
+    size_t next_ = 0;
+    Sink sink_;
+    void* ctx_;
+    std::vector<int64_t> latencies_;
+};
+
+}  // namespace ringsim
@@ -0,0 +1,105 @@
+#include "xor_pads.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RINGSIM_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace ringsim {
+
+namespace {
+
+using Kernel = void (*)(const uint8_t*, const uint8_t*, uint8_t*, size_t);
+
+// Word at a time through memcpy, which compiles to unaligned loads and stores
+void xor_tail(const uint8_t* data, const uint8_t* pad, uint8_t* out, size_t bytes) {
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t a, b;
+        std::memcpy(&a, data + i, 8);
+        std::memcpy(&b, pad + i, 8);
+        a ^= b;
+        std::memcpy(out + i, &a, 8);
+    }
+    for (; i < bytes; ++i) {
+        out[i] = data[i] ^ pad[i];
+    }
+}
+
+#ifdef RINGSIM_X86
+__attribute__((target("avx2"))) void xor_avx2(const uint8_t* data, const uint8_t* pad, uint8_t* out,
+                                              size_t bytes) {
+    size_t i = 0;
+    for (; i + 64 <= bytes; i += 64) {
+        const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+        const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pad + i));
+        const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pad + i + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(a0, b0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 32), _mm256_xor_si256(a1, b1));
+    }
+    xor_tail(data + i, pad + i, out + i, bytes - i);
+}
+
+__attribute__((target("avx512f"))) void xor_avx512(const uint8_t* data, const uint8_t* pad, uint8_t* out,
+                                                   size_t bytes) {
+    size_t i = 0;
+    for (; i + 128 <= bytes; i += 128) {
+        const __m512i a0 = _mm512_loadu_si512(data + i);
+        const __m512i a1 = _mm512_loadu_si512(data + i + 64);
+        const __m512i b0 = _mm512_loadu_si512(pad + i);
+        const __m512i b1 = _mm512_loadu_si512(pad + i + 64);
+        _mm512_storeu_si512(out + i, _mm512_xor_si512(a0, b0));
+        _mm512_storeu_si512(out + i + 64, _mm512_xor_si512(a1, b1));
+    }
+    xor_tail(data + i, pad + i, out + i, bytes - i);
+}
+#elif defined(__ARM_NEON)
+void xor_neon(const uint8_t* data, const uint8_t* pad, uint8_t* out, size_t bytes) {
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        vst1q_u8(out + i, veorq_u8(vld1q_u8(data + i), vld1q_u8(pad + i)));
+        vst1q_u8(out + i + 16, veorq_u8(vld1q_u8(data + i + 16), vld1q_u8(pad + i + 16)));
+    }
+    xor_tail(data + i, pad + i, out + i, bytes - i);
+}
+#endif
+
+struct Dispatch {
+    Kernel kernel;
+    const char* name;
+};
+
+Dispatch select() {
+#ifdef RINGSIM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return {xor_avx512, "avx512"};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return {xor_avx2, "avx2"};
+    }
+#elif defined(__ARM_NEON)
+    return {xor_neon, "neon"};
+#endif
+    return {xor_tail, "scalar"};
+}
+
+const Dispatch& dispatch() {
+    static const Dispatch chosen = select();
+    return chosen;
+}
+
+}  // namespace
+
+void xor_pads(const uint8_t* data, const uint8_t* pad, uint8_t* out, size_t bytes) {
+    dispatch().kernel(data, pad, out, bytes);
+}
+
+const char* xor_kernel_name() { return dispatch().name; }
+
+}  // namespace ringsim
@@ -0,0 +1,17 @@
+// XOR kernels for the batched encryption stage (see src/encryption.py).
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ringsim {
+
+// out[i] = data[i] ^ pad[i] for bytes bytes. out may alias data. The widest
+// kernel the CPU supports (AVX-512, AVX2, NEON or 64-bit scalar) is picked
+// once at first use.
+void xor_pads(const uint8_t* data, const uint8_t* pad, uint8_t* out, size_t bytes);
+
+// Name of the kernel xor_pads() dispatches to.
+const char* xor_kernel_name();
+
+}  // namespace ringsim
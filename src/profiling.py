@@ -0,0 +1,87 @@
+"""
+Phase profile of the native Scenario loop for run_scenario(profile=...).
+
+The native core times the phases of sampled loop iterations (one in every
+`every`) and adds their inclusive totals into a Profile:
+
+    step      one whole loop iteration
+    tick      network delivery
+    movers    legal-mover computation (and its incremental upkeep)
+    move      applying a move
+    enqueue   broadcasting the new position, within move
+
+Each phase reports its calls, nanoseconds and, where the platform grants
+perf events (see /proc/sys/kernel/perf_event_paranoid), CPU cycles, cache
+misses and branch misses; without them those stay 0 and
+hardware_counters is False. collapsed() renders any of those metrics in
+the folded-stack format of flamegraph.pl and speedscope, one line per
+phase with its exclusive total.
+"""
+
+PHASES = ("step", "tick", "movers", "move", "enqueue")
+METRICS = ("nanoseconds", "cycles", "cache_misses", "branch_misses")
+
+# Phase nesting in the native loop; step is the root
+PARENT = {"tick": "step", "movers": "step", "move": "step", "enqueue": "move"}
+
+
+def _stack(phase):
+    path = [phase]
+    while path[-1] in PARENT:
+        path.append(PARENT[path[-1]])
+    return path[::-1]
+
+
+class Profile:
+    """
+    Accumulates phase totals over the runs it is passed to. hardware asks
+    for the perf event counters.
+    """
+    def __init__(self, every=1, hardware=True):
+        if every < 1:
+            raise ValueError("profile sampling interval must be positive")
+        self.every = every
+        self.hardware = hardware
+        self.hardware_counters = False
+        self.runs = 0
+        self.phases = {phase: dict.fromkeys(("calls",) + METRICS, 0) for phase in PHASES}
+
+    def add(self, phases, hardware_counters):
+        """Adds one run's totals: a mapping of phase to {calls, metric...}."""
+        for phase, totals in phases.items():
+            for key, value in totals.items():
+                self.phases[phase][key] += value
+        self.hardware_counters = hardware_counters
+        self.runs += 1
+
+    def exclusive(self, metric="nanoseconds"):
+        """metric per phase, less what its child phases account for."""
+        own = {phase: self.phases[phase][metric] for phase in PHASES}
+        for phase, parent in PARENT.items():
+            own[parent] -= self.phases[phase][metric]
+        # Clock reads at scope edges can make a parent come out a hair short
+        return {phase: max(value, 0) for phase, value in own.items()}
+
+    def collapsed(self, metric="nanoseconds", root="run_scenario"):
+        """Folded stacks ("root;step;move;enqueue 1234") of the non-zero exclusive totals."""
+        if metric not in METRICS:
+            raise ValueError(f"unknown profile metric {metric!r}")
+        return [";".join([root] + _stack(phase)) + f" {value}"
+                for phase, value in self.exclusive(metric).items() if value > 0]
+
+    def write_collapsed(self, sink, metric="nanoseconds", root="run_scenario"):
+        """Writes collapsed() to sink, a path or a text file-like object."""
+        text = "".join(line + "\n" for line in self.collapsed(metric, root))
+        if hasattr(sink, "write"):
+            sink.write(text)
+        else:
+            with open(sink, "w") as f:
+                f.write(text)
+
+    def as_dict(self):
+        return {
+            "every": self.every,
+            "runs": self.runs,
+            "hardware_counters": self.hardware_counters,
+            "phases": {phase: dict(totals) for phase, totals in self.phases.items()},
+        }
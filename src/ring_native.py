@@ -0,0 +1,519 @@
+"""
+ctypes bindings for the native simulation core in src/native.
+
+The shared library is built with CMake (see README) and is looked up at
+RING_SIM_NATIVE_LIB, then next to this file.
+"""
+import ctypes
+import os
+import struct
+import sys
+from array import array
+
+try:
+    from .profiling import PHASES
+except ImportError:
+    from profiling import PHASES
+
+_LIB_BASENAME = "_ring_core"
+
+RINGSIM_OK = 0
+RINGSIM_SECURITY_FAILURE = 1
+RINGSIM_INVALID_ARGUMENT = 2
+RINGSIM_CHECKPOINT_ERROR = 4
+
+
+class CheckpointError(OSError):
+    """A snapshot could not be written, read, or does not match the run."""
+
+
+class _Event(ctypes.Structure):
+    _fields_ = [
+        ("tick", ctypes.c_int64),
+        ("index", ctypes.c_int64),
+        ("queue_depth", ctypes.c_int32),
+        ("party", ctypes.c_int32),
+        ("move", ctypes.c_uint8),
+        ("padding", ctypes.c_uint8 * 7),
+    ]
+
+
+_TELEMETRY_FN = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.POINTER(_Event), ctypes.c_int64)
+_LATENCY_FN = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.POINTER(ctypes.c_int64),
+                               ctypes.c_int64)
+
+
+class _Arrivals(ctypes.Structure):
+    _fields_ = [
+        ("kind", ctypes.c_int32),
+        ("padding", ctypes.c_int32),
+        ("rate", ctypes.c_double),
+        ("mean_on", ctypes.c_double),
+        ("mean_off", ctypes.c_double),
+    ]
+
+
+class _Phase(ctypes.Structure):
+    _fields_ = [
+        ("calls", ctypes.c_int64),
+        ("nanoseconds", ctypes.c_int64),
+        ("cycles", ctypes.c_int64),
+        ("cache_misses", ctypes.c_int64),
+        ("branch_misses", ctypes.c_int64),
+    ]
+
+
+class _Profile(ctypes.Structure):
+    _fields_ = [
+        ("every", ctypes.c_int64),
+        ("hardware", ctypes.c_int32),
+        ("hardware_counters", ctypes.c_int32),
+        ("phases", _Phase * len(PHASES)),
+    ]
+
+
+class _Config(ctypes.Structure):
+    _fields_ = [
+        ("n", ctypes.c_int64),
+        ("m", ctypes.c_int64),
+        ("d", ctypes.c_int64),
+        ("x", ctypes.c_int64),
+        ("rng_state", ctypes.c_uint64),
+        ("rng_inc", ctypes.c_uint64),
+        ("coalesce", ctypes.c_int32),
+        ("skip_drift", ctypes.c_int32),
+        ("incremental", ctypes.c_int32),
+        ("event_driven", ctypes.c_int32),
+        ("neighbor_only", ctypes.c_int32),
+        ("batch", ctypes.c_int32),
+        ("mapped_bitmap", ctypes.c_int32),
+        ("intervals", ctypes.c_int32),
+        ("adaptive", ctypes.c_int32),
+        ("link_delay", ctypes.c_int64),
+        ("delay_cdf", ctypes.POINTER(ctypes.c_uint64)),
+        ("delay_cdf_rows", ctypes.c_int64),
+        ("delay_cdf_width", ctypes.c_int64),
+        ("delay_trace", ctypes.c_char_p),
+        ("traffic", ctypes.c_int32),
+        ("traffic_padding", ctypes.c_int32),
+        ("arrivals", ctypes.POINTER(_Arrivals)),
+        ("message_trace", ctypes.c_char_p),
+        ("traffic_until", ctypes.c_int64),
+        ("latency", _LATENCY_FN),
+        ("latency_ctx", ctypes.c_void_p),
+        ("telemetry", _TELEMETRY_FN),
+        ("telemetry_ctx", ctypes.c_void_p),
+        ("telemetry_capacity", ctypes.c_int64),
+        ("checkpoint_path", ctypes.c_char_p),
+        ("checkpoint_every", ctypes.c_int64),
+        ("shards", ctypes.c_int64),
+        ("fixed_kernels", ctypes.c_int32),
+        ("with_stats", ctypes.c_int32),
+        ("profile", ctypes.POINTER(_Profile)),
+    ]
+
+
+class _Result(ctypes.Structure):
+    _fields_ = [
+        ("waste", ctypes.c_int64),
+        ("reused_index", ctypes.c_int64),
+        ("rng_state", ctypes.c_uint64),
+        ("messages_arrived", ctypes.c_int64),
+        ("ticks", ctypes.c_int64),
+        ("iterations", ctypes.c_int64),
+        ("broadcasts", ctypes.c_int64),
+        ("delivered", ctypes.c_int64),
+        ("view_updates", ctypes.c_int64),
+        ("data_moves", ctypes.c_int64),
+        ("drift_moves", ctypes.c_int64),
+        ("yield_moves", ctypes.c_int64),
+        ("blocked_ticks", ctypes.c_int64),
+        ("max_queue_depth", ctypes.c_int64),
+        ("status_evaluations", ctypes.c_int64),
+        ("network_s", ctypes.c_double),
+        ("moves_s", ctypes.c_double),
+    ]
+
+_STATS_FIELDS = tuple(name for name, _ in _Result._fields_[4:])
+
+
+_lib = None
+
+
+def _candidate_paths():
+    override = os.environ.get("RING_SIM_NATIVE_LIB")
+    if override:
+        yield override
+        return
+    here = os.path.dirname(os.path.abspath(__file__))
+    suffix = {"win32": ".dll", "darwin": ".dylib"}.get(sys.platform, ".so")
+    yield os.path.join(here, _LIB_BASENAME + suffix)
+
+
+def library_path():
+    """Path of the library load() opens first, built or not."""
+    return next(_candidate_paths())
+
+
+def load():
+    """Loads the native library once; raises OSError if it has not been built."""
+    global _lib
+    if _lib is not None:
+        return _lib
+    errors = []
+    for path in _candidate_paths():
+        try:
+            lib = ctypes.CDLL(path)
+            break
+        except OSError as exc:
+            errors.append(f"{path}: {exc}")
+    else:
+        raise OSError(
+            "native ring_sim core not built (run `cmake -S . -B build && cmake --build build`): "
+            + "; ".join(errors)
+        )
+    lib.ringsim_version.restype = ctypes.c_char_p
+    lib.ringsim_last_error.restype = ctypes.c_char_p
+    lib.ringsim_run_scenario.argtypes = [ctypes.POINTER(_Config), ctypes.POINTER(_Result)]
+    lib.ringsim_run_scenario.restype = ctypes.c_int
+    lib.ringsim_run_batch.argtypes = [
+        ctypes.POINTER(_Config), ctypes.c_int64, ctypes.POINTER(ctypes.c_uint64),
+        ctypes.POINTER(ctypes.c_uint64), ctypes.POINTER(_Result),
+    ]
+    lib.ringsim_run_batch.restype = ctypes.c_int
+    lib.ringsim_xor_pads.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p,
+                                     ctypes.c_int64]
+    lib.ringsim_xor_pads.restype = None
+    lib.ringsim_xor_kernel.restype = ctypes.c_char_p
+    lib.ringsim_fixed_kernel.argtypes = [ctypes.POINTER(_Config)]
+    lib.ringsim_fixed_kernel.restype = ctypes.c_int64
+    lib.ringsim_allocator_create.argtypes = [ctypes.c_int64] * 4
+    lib.ringsim_allocator_create.restype = ctypes.c_void_p
+    lib.ringsim_allocator_destroy.argtypes = [ctypes.c_void_p]
+    lib.ringsim_allocator_destroy.restype = None
+    for name in ("reserve", "position", "used"):
+        getattr(lib, f"ringsim_allocator_{name}").argtypes = [ctypes.c_void_p]
+        getattr(lib, f"ringsim_allocator_{name}").restype = ctypes.c_int64
+    lib.ringsim_allocator_set_front.argtypes = [ctypes.c_void_p, ctypes.c_int64]
+    lib.ringsim_allocator_set_front.restype = None
+    lib.ringsim_allocator_burn.argtypes = [ctypes.c_void_p, ctypes.c_int64]
+    lib.ringsim_allocator_burn.restype = ctypes.c_int32
+    lib.ringsim_allocator_contend.argtypes = [
+        ctypes.c_void_p, ctypes.c_int32, ctypes.c_int64, ctypes.POINTER(ctypes.c_int64),
+    ]
+    lib.ringsim_allocator_contend.restype = ctypes.c_int
+    _lib = lib
+    return lib
+
+
+# CheckpointHeader in src/native/checkpoint.hpp (native byte order)
+_CHECKPOINT_HEADER = struct.Struct("=8sQqqqqQQQq4qqqQQ")
+_CHECKPOINT_FIELDS = ("magic", "version", "n", "m", "d", "x", "flags", "rng_state", "rng_inc",
+                      "iterations", "data_moves", "drift_moves", "yield_moves", "blocked_ticks",
+                      "status_evaluations", "burned", "bitset_offset", "bitset_words")
+
+
+def checkpoint_info(path):
+    """Header fields of a snapshot written by run_scenario(..., checkpoint=path)."""
+    with open(path, "rb") as stream:
+        raw = stream.read(_CHECKPOINT_HEADER.size)
+    if len(raw) < _CHECKPOINT_HEADER.size or not raw.startswith(b"RINGCKPT"):
+        raise CheckpointError(f"not a ring_sim checkpoint: {path}")
+    info = dict(zip(_CHECKPOINT_FIELDS, _CHECKPOINT_HEADER.unpack(raw)))
+    del info["magic"]
+    return info
+
+
+def available():
+    try:
+        load()
+    except OSError:
+        return False
+    return True
+
+
+def _check(status, result):
+    if status == RINGSIM_SECURITY_FAILURE:
+        raise RuntimeError(f"CRITICAL SECURITY FAILURE: Pad index {result.reused_index} reused!")
+    if status == RINGSIM_CHECKPOINT_ERROR:
+        raise CheckpointError(load().ringsim_last_error().decode(errors="replace"))
+    if status == RINGSIM_INVALID_ARGUMENT:
+        detail = load().ringsim_last_error().decode(errors="replace")
+        raise ValueError(detail or "invalid ring configuration")
+    if status != RINGSIM_OK:
+        raise RuntimeError(f"native ring_sim core failed with status {status}")
+
+
+def _validate(n, m, d, x):
+    if m < 1 or n < 1 or d < 0:
+        raise ValueError(f"invalid ring configuration (n={n}, m={m}, d={d})")
+    if not 0 <= x <= m:
+        raise ValueError("Sample larger than population or is negative")
+
+
+def _make_config(n, m, d, x, rng_state, rng_inc, coalesce, skip_drift, incremental, event_driven,
+                 neighbor_only, batch, mapped_bitmap, intervals, adaptive, link_delay):
+    return _Config(n, m, d, x, rng_state, rng_inc, int(coalesce), int(skip_drift),
+                   int(incremental), int(event_driven), int(neighbor_only), int(batch),
+                   int(mapped_bitmap), int(intervals), int(adaptive),
+                   d if link_delay is None else link_delay)
+
+
+def _set_delays(cfg, delay_cdf, delay_trace):
+    """
+    Points cfg at a delay model: delay_cdf is a list of equally long
+    threshold rows (see delays.TableDelay), delay_trace a trace file path.
+    Returns the buffer backing the rows, which must outlive the call.
+    """
+    if delay_trace is not None:
+        cfg.delay_trace = os.fsencode(delay_trace)
+    if delay_cdf is None:
+        return None
+    width = len(delay_cdf[0])
+    if any(len(row) != width for row in delay_cdf):
+        raise ValueError("delay CDF rows must be equally long")
+    flat = (ctypes.c_uint64 * max(1, width * len(delay_cdf)))(
+        *(t for row in delay_cdf for t in row))
+    cfg.delay_cdf = ctypes.cast(flat, ctypes.POINTER(ctypes.c_uint64))
+    cfg.delay_cdf_rows, cfg.delay_cdf_width = len(delay_cdf), width
+    return flat
+
+
+def _set_traffic(cfg, traffic, latencies, errors):
+    """
+    Points cfg at a traffic.Workload, whose Poisson and on/off processes
+    the native core draws itself; latencies collects the latency stream.
+    Returns the buffers and callback that must outlive the call.
+    """
+    processes = (_Arrivals * traffic.m)()
+    for slot, process in zip(processes, traffic.arrivals):
+        if process is not None:
+            if process.kind not in (1, 2):
+                raise TypeError(f"the native core cannot draw from {type(process).__name__}")
+            slot.kind, slot.rate = process.kind, process.rate
+            slot.mean_on, slot.mean_off = process.mean_on, process.mean_off
+    cfg.traffic = 1
+    cfg.arrivals = ctypes.cast(processes, ctypes.POINTER(_Arrivals))
+    if traffic.trace is not None:
+        cfg.message_trace = os.fsencode(traffic.trace.path)
+    cfg.traffic_until = -1 if traffic.until is None else traffic.until
+
+    def sink(ctx, values, count):
+        try:
+            latencies.frombytes(ctypes.string_at(values, count * 8))
+        except BaseException as exc:  # cannot propagate through the C frames
+            errors.append(exc)
+    cfg.latency = _LATENCY_FN(sink)
+    return processes, cfg.latency
+
+
+def _outcome(result, with_stats):
+    if with_stats:
+        return result.waste, {name: getattr(result, name) for name in _STATS_FIELDS}
+    return result.waste
+
+
+def _telemetry_sink(telemetry, errors):
+    """C callback passing native event chunks to a telemetry.TelemetryBuffer."""
+    def sink(ctx, events, count):
+        try:
+            telemetry.emit(ctypes.string_at(events, count * ctypes.sizeof(_Event)))
+        except BaseException as exc:  # cannot propagate through the C frames
+            errors.append(exc)
+    return _TELEMETRY_FN(sink)
+
+
+def run_scenario(n, m, d, x, rng, with_stats=False, coalesce=False, skip_drift=False,
+                 incremental=False, event_driven=False, neighbor_only=False,
+                 batch=False, mapped_bitmap=False, intervals=False, telemetry=None,
+                 checkpoint=None, checkpoint_every=0, adaptive=False, link_delay=None,
+                 delay_cdf=None, delay_trace=None, traffic=None, shards=0, fixed_kernels=False,
+                 profile=None):
+    """
+    Native equivalent of ring_sim.run_scenario; returns the count of unused
+    pads, or (unused pads, counters dict) with with_stats. rng is an rng.Pcg32;
+    the run starts from its state and advances it exactly as the Python backend
+    would. telemetry, a telemetry.TelemetryBuffer, receives the native event
+    stream in chunks of its capacity. mapped_bitmap keeps the burned bitset in
+    a mapped temporary file under TMPDIR instead of RAM; intervals tracks
+    burned pads as sorted runs instead (without checkpoint support). checkpoint
+    is a snapshot path: an existing snapshot is resumed, a new one saved every
+    checkpoint_every iterations, and the file removed when the run ends;
+    failures raise CheckpointError. adaptive and link_delay (None for d) are as
+    in ring_sim.run_scenario; delay_cdf (threshold rows) or delay_trace (a
+    trace path) replace the uniform delays, see ring_sim._native_delays.
+    traffic, a traffic.Workload, drives the senders as in ring_sim.run_scenario
+    and receives the run's messages and latencies (Workload.adopt). shards > 0
+    runs schedule='sharded' on that many threads. fixed_kernels lets m in
+    {2, 3, 4, 8} run on the specialized kernels of src/native/fixed_ring.hpp
+    where they apply (see fixed_kernel); results are the same either way.
+    profile, a profiling.Profile, receives the phase totals of the run (the
+    generic engine runs it).
+    """
+    _validate(n, m, d, x)
+    lib = load()
+    cfg = _make_config(n, m, d, x, rng.state, rng.inc, coalesce, skip_drift, incremental,
+                       event_driven, neighbor_only, batch, mapped_bitmap, intervals, adaptive,
+                       link_delay)
+    delay_rows = _set_delays(cfg, delay_cdf, delay_trace)  # alive until the call returns
+    cfg.shards = shards
+    cfg.fixed_kernels = int(fixed_kernels)
+    cfg.with_stats = int(with_stats)
+    if checkpoint is not None:
+        cfg.checkpoint_path = os.fsencode(checkpoint)
+        cfg.checkpoint_every = checkpoint_every
+    errors = []
+    latencies = array("q")
+    if traffic is not None:
+        workload_buffers = _set_traffic(cfg, traffic, latencies, errors)  # alive as delay_rows
+    if telemetry is not None:
+        telemetry.flush()
+        cfg.telemetry = _telemetry_sink(telemetry, errors)
+        cfg.telemetry_capacity = telemetry.capacity
+    if profile is not None:
+        phases = _Profile(every=profile.every, hardware=int(profile.hardware))
+        cfg.profile = ctypes.pointer(phases)
+    result = _Result()
+    status = lib.ringsim_run_scenario(ctypes.byref(cfg), ctypes.byref(result))
+    if errors:
+        raise errors[0]
+    if profile is not None and status in (RINGSIM_OK, RINGSIM_SECURITY_FAILURE):
+        profile.add({name: {key: getattr(phase, key) for key, _ in _Phase._fields_}
+                     for name, phase in zip(PHASES, phases.phases)},
+                    bool(phases.hardware_counters))
+    if status in (RINGSIM_OK, RINGSIM_SECURITY_FAILURE):
+        rng.state = result.rng_state
+    _check(status, result)
+    if traffic is not None:
+        traffic.adopt(result.messages_arrived, latencies)
+    return _outcome(result, with_stats)
+
+
+def run_batch(n, m, d, x, rngs, with_stats=False, coalesce=False, skip_drift=False,
+              incremental=False, event_driven=False, neighbor_only=False, batch=False,
+              mapped_bitmap=False, intervals=False, adaptive=False, link_delay=None,
+              delay_cdf=None, delay_trace=None, fixed_kernels=False):
+    """
+    Runs one scenario per rng.Pcg32 in rngs inside a single native call and
+    returns their results in order. Each rng is advanced exactly as
+    run_scenario would advance it, fixed_kernels included. If any scenario
+    reuses a pad, the first such failure is raised after every scenario has
+    finished.
+    """
+    _validate(n, m, d, x)
+    lib = load()
+    rngs = list(rngs)
+    count = len(rngs)
+    # The generator in cfg is unused: each scenario draws from its own rng
+    cfg = _make_config(n, m, d, x, 0, 0, coalesce, skip_drift, incremental, event_driven,
+                       neighbor_only, batch, mapped_bitmap, intervals, adaptive, link_delay)
+    delay_rows = _set_delays(cfg, delay_cdf, delay_trace)  # alive until the call returns
+    cfg.fixed_kernels = int(fixed_kernels)
+    cfg.with_stats = int(with_stats)
+    states = (ctypes.c_uint64 * count)(*(rng.state for rng in rngs))
+    incs = (ctypes.c_uint64 * count)(*(rng.inc for rng in rngs))
+    results = (_Result * count)()
+    status = lib.ringsim_run_batch(ctypes.byref(cfg), count, states, incs, results)
+    if status in (RINGSIM_OK, RINGSIM_SECURITY_FAILURE):
+        for rng, result in zip(rngs, results):
+            rng.state = result.rng_state
+    _check(status, next((result for result in results if result.reused_index >= 0), None))
+    return [_outcome(result, with_stats) for result in results]
+
+
+def xor_pads(buf, pad, pad_offset=0):
+    """
+    XORs pad[pad_offset:pad_offset + len(buf)] into buf in place with the
+    native SIMD kernel. buf and pad must be writable buffers (a bytearray,
+    or an mmap opened with ACCESS_WRITE or ACCESS_COPY).
+    """
+    size = len(buf)
+    if pad_offset < 0 or pad_offset + size > len(pad):
+        raise ValueError("pad range out of bounds")
+    if size == 0:
+        return
+    target = (ctypes.c_char * size).from_buffer(buf)
+    source = (ctypes.c_char * size).from_buffer(pad, pad_offset)
+    load().ringsim_xor_pads(target, source, target, size)
+
+
+def xor_kernel():
+    """Name of the XOR kernel the native core selected for this CPU."""
+    return load().ringsim_xor_kernel().decode()
+
+
+def fixed_kernel(n, m, d, x, coalesce=False, skip_drift=False, incremental=False,
+                 event_driven=False, neighbor_only=False, batch=False, mapped_bitmap=False,
+                 intervals=False, adaptive=False, link_delay=None, delay_cdf=None,
+                 delay_trace=None):
+    """
+    m of the specialized kernel run_scenario(..., fixed_kernels=True) runs
+    these options on, or 0 for the generic engine. Telemetry, checkpoints,
+    traffic and shards always take the generic engine.
+    """
+    cfg = _make_config(n, m, d, x, 0, 0, coalesce, skip_drift, incremental, event_driven,
+                       neighbor_only, batch, mapped_bitmap, intervals, adaptive, link_delay)
+    delay_rows = _set_delays(cfg, delay_cdf, delay_trace)  # alive until the call returns
+    cfg.fixed_kernels = 1
+    return load().ringsim_fixed_kernel(ctypes.byref(cfg))
+
+
+class PadAllocator:
+    """
+    Lock-free pad reservation for one party whose threads send at the same
+    time (src/native/pad_allocator.hpp). reserve() returns a fresh index from
+    the party's arc, or None while the gap to its view of the front
+    neighbour is at most d; it never returns the same pad twice, however many
+    threads call it. ctypes releases the GIL around each call, so Python
+    threads really do contend.
+    """
+    def __init__(self, n, d, start, front):
+        self._lib = load()
+        self.n = n
+        self._handle = self._lib.ringsim_allocator_create(n, d, start, front)
+        if not self._handle:
+            raise ValueError(f"invalid allocator configuration (n={n}, d={d}, start={start}, "
+                             f"front={front})")
+
+    def reserve(self):
+        idx = self._lib.ringsim_allocator_reserve(self._handle)
+        return None if idx < 0 else idx
+
+    def set_front(self, index):
+        """Delivers a new view of the front neighbour's position."""
+        self._lib.ringsim_allocator_set_front(self._handle, index % self.n)
+
+    def burn(self, index):
+        """Marks a pad burned by another party; returns False if it already was."""
+        if not 0 <= index < self.n:
+            raise IndexError(index)
+        return bool(self._lib.ringsim_allocator_burn(self._handle, index))
+
+    @property
+    def position(self):
+        return self._lib.ringsim_allocator_position(self._handle)
+
+    @property
+    def used(self):
+        return self._lib.ringsim_allocator_used(self._handle)
+
+    def contend(self, threads, attempts):
+        """
+        Runs `threads` native threads that each call reserve() `attempts`
+        times and returns every index they obtained.
+        """
+        out = (ctypes.c_int64 * (threads * attempts))()
+        status = self._lib.ringsim_allocator_contend(self._handle, threads, attempts, out)
+        if status == RINGSIM_INVALID_ARGUMENT:
+            raise ValueError("threads must be positive and attempts non-negative")
+        if status != RINGSIM_OK:
+            raise RuntimeError(f"native ring_sim core failed with status {status}")
+        return [idx for idx in out if idx >= 0]
+
+    def close(self):
+        if self._handle:
+            self._lib.ringsim_allocator_destroy(self._handle)
+            self._handle = None
+
+    def __del__(self):
+        self.close()
@@ -1,5 +1,38 @@
+import os
 import random
-import statistics
+import time
+from array import array
+from collections import deque
+from collections.abc import MutableMapping
+from dataclasses import dataclass, field
+
+try:
+    from . import burned_pads, delays, ring_native
+    from .rng import Pcg32, make_rng
+    from .telemetry import BLOCKED, DATA, DRIFT, YIELD
+except ImportError:
+    import burned_pads
+    import delays
+    import ring_native
+    from rng import Pcg32, make_rng
+    from telemetry import BLOCKED, DATA, DRIFT, YIELD
+
+BACKENDS = ("python", "native")
+DRIFT_STEP = "step"
+DRIFT_SKIP = "skip"
+MOVERS_SCAN = "scan"
+MOVERS_INCREMENTAL = "incremental"
+PROPAGATE_BROADCAST = "broadcast"
+PROPAGATE_NEIGHBOR = "neighbor"
+PROPAGATIONS = (PROPAGATE_BROADCAST, PROPAGATE_NEIGHBOR)
+SCHEDULE_SINGLE = "single"
+SCHEDULE_BATCH = "batch"
+SCHEDULE_SHARDED = "sharded"
+SCHEDULES = (SCHEDULE_SINGLE, SCHEDULE_BATCH, SCHEDULE_SHARDED)
+CHECKPOINT_EVERY = 10_000_000  # loop iterations between snapshots
+ADAPTIVE_PERCENTILE = 99  # delay percentile an adaptive party covers
+ADAPTIVE_WINDOW = 1024    # samples between halvings of the delay histogram
+ADAPTIVE_MIN_SAMPLES = 100  # samples before a party trusts its estimate
 
 
 class AsynchronousNetwork:
@@ -8,31 +41,291 @@ class AsynchronousNetwork:
     variable delay. Broadcast updates the current position
     of the party to all members. Tick acts as the
     global clock and decides the delivery of messages.
+
+    Pending messages live in a timing wheel of d_delay + 1 buckets, one per
+    tick in the delivery horizon, so send and delivery are O(1) per message.
+    A message lands in the bucket of the first tick at which it is due, and
+    buckets keep send order, which is the order the messages are applied in.
+
+    With coalesce=True the latest position wins: an update supersedes every
+    in-flight update from the same sender that would arrive no earlier than
+    it, so each tick applies at most one update per sender and views never
+    move back to an older position.
+
+    With propagation='neighbor' an update is applied only to the sender's ring
+    predecessor, the one party whose move rule reads it, so delivery costs
+    O(1) instead of O(m). view_updates counts the per-party view writes, i.e.
+    the messages a point-to-point deployment would send.
+
+    With drop_stale=True an update that arrives after a later one from the
+    same sender is dropped, as a receiver checking sequence numbers would,
+    so views never move back and parties never pass their front neighbour.
+    Dropped updates count as delivered but write no view.
+
+    Delays are drawn from rng, which defaults to the global random module,
+    uniformly from [0, d_delay] unless a model from src/delays.py is given
+    as delay_model; d_delay is then the model's max_delay. Each message
+    carries its send tick, so the delay of an update applied to a PartyState
+    that tracks delays is reported through observe_delay.
     """
-    def __init__(self, d_delay):
+    def __init__(self, d_delay, coalesce=False, rng=None, propagation=PROPAGATE_BROADCAST,
+                 delay_model=None, drop_stale=False):
+        if propagation not in PROPAGATIONS:
+            raise ValueError(f"unknown propagation mode {propagation!r}")
+        if delay_model is not None:
+            d_delay = delay_model.max_delay
+            delay_model.reset()
+        self.delay_model = delay_model
         self.d_delay = d_delay
-        self.queue = []
+        self.coalesce = coalesce
+        self.rng = random if rng is None else rng
+        self.neighbor_only = propagation == PROPAGATE_NEIGHBOR
         self.current_time = 0
+        self.pending = 0
+        self.sent = 0
+        self.delivered = 0
+        self.superseded = 0
+        self.view_updates = 0
+        self.max_pending = 0
+        self._wheel = [{} if coalesce else [] for _ in range(d_delay + 1)]
+        self._inflight = {}  # sender_id -> ascending due ticks (coalesce only)
+        self._applied = {} if drop_stale else None  # sender_id -> send tick of the latest view
+
+    @property
+    def queue(self):
+        """Pending (delivery_time, sender_id, index) messages, in delivery order."""
+        slots = len(self._wheel)
+        buckets = (self._wheel[(self.current_time + t) % slots] for t in range(1, slots + 1))
+        if self.coalesce:
+            return [msg[:3] for bucket in buckets for msg in bucket.values()]
+        return [msg[:3] for bucket in buckets for msg in bucket]
 
     def send_broadcast(self, sender_id, new_index):
-        delivery_time = self.current_time + random.randint(0, self.d_delay)
-        self.queue.append((delivery_time, sender_id, new_index))
+        if self.delay_model is None:
+            delay = self.rng.randint(0, self.d_delay)
+        else:
+            delay = self.delay_model.draw(self.rng, sender_id)
+        delivery_time = self.current_time + delay
+        # Messages are delivered on the next tick at the earliest
+        due = max(delivery_time, self.current_time + 1)
+        msg = (delivery_time, sender_id, new_index, self.current_time)
+        if self.coalesce:
+            self._supersede(sender_id, due)
+            self._wheel[due % len(self._wheel)][sender_id] = msg
+        else:
+            self._wheel[due % len(self._wheel)].append(msg)
+        self.pending += 1
+        self.sent += 1
+        if self.pending > self.max_pending:
+            self.max_pending = self.pending
+
+    def skip_idle(self):
+        """
+        Moves the clock to just before the next tick with a due update, so the
+        following tick() delivers it. Returns the number of ticks skipped.
+        """
+        slots = len(self._wheel)
+        for ahead in range(1, slots + 1):
+            if self._wheel[(self.current_time + ahead) % slots]:
+                self.current_time += ahead - 1
+                return ahead - 1
+        return 0
+
+    def _supersede(self, sender_id, due):
+        """Drops in-flight updates from sender_id due at or after the given tick."""
+        inflight = self._inflight.setdefault(sender_id, deque())
+        while inflight and inflight[-1] >= due:
+            del self._wheel[inflight.pop() % len(self._wheel)][sender_id]
+            self.pending -= 1
+            self.superseded += 1
+        inflight.append(due)
 
-    def tick(self, parties):
+    def tick(self, parties, on_update=None):
+        """
+        Advances the clock and applies every update due at the new time to
+        parties, either a {party_id: RingParty} dict or a PartyState.
+        on_update(sender_id), if given, is called once per applied update.
+        """
         self.current_time += 1
-        delivered = []
-        remaining = []
-        for msg in self.queue:
-            if msg[0] <= self.current_time:
-                delivered.append(msg)
+        bucket = self._wheel[self.current_time % len(self._wheel)]
+        if not bucket:
+            return False
+        if self.coalesce:
+            messages = bucket.values()
+            for sender_id in bucket:
+                self._inflight[sender_id].popleft()
+        else:
+            messages = bucket
+        soa = isinstance(parties, PartyState)
+        m = parties.m if soa else len(parties)
+        observe = parties.observe_delay if soa and parties.estimators and m > 1 else None
+        applied = self._applied
+        for _, sender_id, idx, sent in messages:
+            if applied is not None:
+                if sent <= applied.get(sender_id, -1):
+                    continue
+                applied[sender_id] = sent
+            if observe is not None:
+                observe(sender_id, self.current_time - sent)
+            if self.neighbor_only:
+                predecessor = (sender_id - 2) % m + 1
+                if predecessor != sender_id:
+                    if soa:
+                        parties.neighbor_update(sender_id, idx)
+                    else:
+                        parties[predecessor].update_view(sender_id, idx)
+                    self.view_updates += 1
             else:
-                remaining.append(msg)
-        self.queue = remaining
-        for _, sender_id, idx in delivered:
-            for p_id, party in parties.items():
-                if p_id != sender_id:
-                    party.update_view(sender_id, idx)
-        return len(delivered) > 0
+                if soa:
+                    parties.broadcast_update(sender_id, idx)
+                else:
+                    for p_id, party in parties.items():
+                        if p_id != sender_id:
+                            party.update_view(sender_id, idx)
+                self.view_updates += m - 1
+            if on_update is not None:
+                on_update(sender_id)
+        self.pending -= len(bucket)
+        self.delivered += len(bucket)
+        bucket.clear()
+        return True
+
+
+class DelayEstimator:
+    """
+    Running high-percentile estimate of the delivery delay, in ticks, of the
+    updates one party applies. Delays are counted in a histogram over
+    [0, cap], larger ones in the last bucket; estimate is the smallest delay
+    that at least `percentile` percent of the samples do not exceed, kept
+    current in amortized O(1) per sample. Every `window` samples the counts
+    are halved (rounding up, so no bucket empties), so old samples fade and
+    the estimate follows a link that gets slower or faster.
+    """
+    def __init__(self, cap, percentile=ADAPTIVE_PERCENTILE, window=ADAPTIVE_WINDOW):
+        self.cap, self.percentile, self.window = cap, percentile, window
+        self.counts = [0] * (cap + 1)
+        self.total = 0
+        self.estimate = 0
+        self._covered = 0  # samples <= estimate
+        self._since_decay = 0
+
+    def add(self, delay):
+        """Records one delay; returns the updated estimate."""
+        delay = min(delay, self.cap)
+        self.counts[delay] += 1
+        self.total += 1
+        if delay <= self.estimate:
+            self._covered += 1
+        self._since_decay += 1
+        if self._since_decay == self.window:
+            self.counts = [(count + 1) >> 1 for count in self.counts]
+            self.total = sum(self.counts)
+            self._covered = sum(self.counts[:self.estimate + 1])
+            self._since_decay = 0
+        counts, need = self.counts, self.percentile * self.total
+        while self._covered * 100 < need:
+            self.estimate += 1
+            self._covered += counts[self.estimate]
+        while self.estimate > 0 and (self._covered - counts[self.estimate]) * 100 >= need:
+            self._covered -= counts[self.estimate]
+            self.estimate -= 1
+        return self.estimate
+
+
+class PartyState:
+    """
+    Structure-of-arrays state of all m parties: a flat m x m view matrix
+    (row = receiver, column = sender) plus contiguous my_index and pads_used
+    arrays. Entries are int32 whenever the ring fits, so even m = 256 is a
+    256 KB block instead of m^2 boxed dict entries.
+
+    thresholds holds each party's gap threshold: a party moves only while
+    its view of the front neighbour is more than that many pads ahead.
+    Every threshold is d unless track_delays() turns on the adaptive mode;
+    reserve is their sum, the pads the run leaves unused at the latest.
+    """
+    def __init__(self, n, m, d):
+        self.n, self.m, self.d = n, m, d
+        typecode = "i" if n <= 2**31 - 1 else "q"
+        starts = [i * (n // m) for i in range(m)]
+        self.views = array(typecode, starts * m)
+        self.my_index = array(typecode, starts)
+        self.pads_used = array("q", bytes(8 * m))
+        self.thresholds = array("q", [d]) * m
+        self.reserve = m * d
+        self.estimators = None
+        self._column = array(typecode, [0]) * m
+
+    def track_delays(self, cap):
+        """
+        Adaptive mode: each party estimates the delay of the updates from its
+        front neighbour, the one view its move rule reads, with a
+        DelayEstimator over [0, cap]. Its threshold then follows that
+        estimate, never above d and, with d >= 1, never below 1, so no two
+        parties can land on the same index. Until ADAPTIVE_MIN_SAMPLES delays
+        make the percentile meaningful, a party keeps the worst-case d.
+        """
+        self.estimators = [DelayEstimator(cap) for _ in range(self.m)]
+
+    def observe_delay(self, sender_id, delay):
+        """Feeds the delay of an update from sender_id to its ring predecessor."""
+        reader = (sender_id - 2) % self.m
+        estimator = self.estimators[reader]
+        estimate = estimator.add(delay)
+        if estimator.total < ADAPTIVE_MIN_SAMPLES:
+            return
+        threshold = min(self.d, max(1, estimate))
+        self.reserve += threshold - self.thresholds[reader]
+        self.thresholds[reader] = threshold
+
+    def view(self, receiver_id, sender_id):
+        return self.views[(receiver_id - 1) * self.m + sender_id - 1]
+
+    def broadcast_update(self, sender_id, index):
+        """Writes index into the sender's column for every party but the sender."""
+        m, col = self.m, sender_id - 1
+        own = self.views[col * m + col]
+        self._column[0] = index
+        if m > 1:
+            self._column[1:] = self._column[:1] * (m - 1)
+        self.views[col::m] = self._column
+        self.views[col * m + col] = own
+
+    def neighbor_update(self, sender_id, index):
+        """Writes index into the view of the sender's ring predecessor only."""
+        predecessor = (sender_id - 2) % self.m + 1
+        self.views[(predecessor - 1) * self.m + sender_id - 1] = index
+
+    def parties(self):
+        """{party_id: RingParty} accessors over this state."""
+        return {i: RingParty(i, self.n, self.m, self.d, state=self) for i in range(1, self.m + 1)}
+
+
+class _ViewRow(MutableMapping):
+    """One party's row of the view matrix, exposed as {sender_id: index}."""
+    __slots__ = ("_views", "_offset", "_m")
+
+    def __init__(self, state, party_id):
+        self._views, self._offset, self._m = state.views, (party_id - 1) * state.m - 1, state.m
+
+    def __getitem__(self, sender_id):
+        if not 1 <= sender_id <= self._m:
+            raise KeyError(sender_id)
+        return self._views[self._offset + sender_id]
+
+    def __setitem__(self, sender_id, index):
+        if not 1 <= sender_id <= self._m:
+            raise KeyError(sender_id)
+        self._views[self._offset + sender_id] = index
+
+    def __delitem__(self, sender_id):
+        raise TypeError("views cannot be removed")
+
+    def __iter__(self):
+        return iter(range(1, self._m + 1))
+
+    def __len__(self):
+        return self._m
 
 
 class RingParty:
@@ -41,23 +334,197 @@ class RingParty:
     all nodes in the ring through view_of_others and my_index. Updates
     positions when receiving broadcast messages. Ensures there exists a
     gap of D between my_index and last position of neighbours
+
+    A RingParty is a thin accessor over one row of a PartyState; a party
+    created without a state gets a private one.
     """
-    def __init__(self, party_id, n, m, d):
+    def __init__(self, party_id, n, m, d, state=None):
         self.party_id = party_id
         self.n, self.m, self.d = n, m, d
-        self.my_index = (party_id - 1) * (n // m)
-        self.view_of_others = {i + 1: (i * (n // m)) for i in range(m)}
-        self.pads_used = 0
+        self._state = state if state is not None else PartyState(n, m, d)
+        self.view_of_others = _ViewRow(self._state, party_id)
+
+    @property
+    def my_index(self):
+        return self._state.my_index[self.party_id - 1]
+
+    @my_index.setter
+    def my_index(self, index):
+        self._state.my_index[self.party_id - 1] = index
+
+    @property
+    def pads_used(self):
+        return self._state.pads_used[self.party_id - 1]
+
+    @pads_used.setter
+    def pads_used(self, count):
+        self._state.pads_used[self.party_id - 1] = count
+
+    @property
+    def gap_threshold(self):
+        """Gap to the front neighbour this party needs before it moves."""
+        return self._state.thresholds[self.party_id - 1]
+
+    @property
+    def delay_estimator(self):
+        """This party's DelayEstimator in adaptive mode, else None."""
+        estimators = self._state.estimators
+        return estimators[self.party_id - 1] if estimators else None
 
     def update_view(self, sender_id, index):
         self.view_of_others[sender_id] = index
 
 
-def run_scenario(n, m, d, x):
+@dataclass
+class ScenarioStats:
+    """Counters of one run, returned by run_scenario(..., with_stats=True)."""
+    ticks: int = 0       # simulated clock when the run stopped
+    iterations: int = 0  # loop iterations; fewer than ticks in event-driven mode
+    broadcasts: int = 0  # position updates sent
+    delivered: int = 0   # updates applied, after coalescing
+    view_updates: int = 0  # per-party view writes, i.e. point-to-point messages
+    data_moves: int = 0    # moves by kind; each one sends a broadcast
+    drift_moves: int = 0
+    yield_moves: int = 0
+    blocked_ticks: int = 0  # iterations in which nobody could move
+    max_queue_depth: int = 0  # most updates in flight at once
+    status_evaluations: int = 0  # get_move_status calls
+    # Wall time in seconds spent delivering updates and selecting/applying moves
+    network_s: float = field(default=0.0, compare=False)
+    moves_s: float = field(default=0.0, compare=False)
+
+
+class LegalMovers:
+    """
+    Party ids that can currently move, kept in a dense array with swap-remove
+    so that membership updates and uniform selection are O(1).
+    """
+    def __init__(self):
+        self.ids = []
+        self._slot = {}
+
+    def update(self, p_id, legal):
+        slot = self._slot.get(p_id)
+        if legal and slot is None:
+            self._slot[p_id] = len(self.ids)
+            self.ids.append(p_id)
+        elif not legal and slot is not None:
+            last = self.ids.pop()
+            del self._slot[p_id]
+            if last != p_id:
+                self.ids[slot] = last
+                self._slot[last] = slot
+
+
+def _native_flags(coalesce, drift, movers, event_driven, propagation, schedule, tracker):
+    """Validates run_scenario options and maps them onto ring_native flags."""
+    if tracker not in burned_pads.TRACKERS:
+        raise ValueError(f"unknown burned-pad tracker {tracker!r}, "
+                         f"expected one of {burned_pads.TRACKERS}")
+    if drift not in (DRIFT_STEP, DRIFT_SKIP):
+        raise ValueError(f"unknown drift mode {drift!r}")
+    if movers not in (MOVERS_SCAN, MOVERS_INCREMENTAL):
+        raise ValueError(f"unknown mover selection {movers!r}")
+    if propagation not in PROPAGATIONS:
+        raise ValueError(f"unknown propagation mode {propagation!r}")
+    if schedule not in SCHEDULES:
+        raise ValueError(f"unknown schedule {schedule!r}")
+    return dict(coalesce=coalesce, skip_drift=drift == DRIFT_SKIP,
+                incremental=movers == MOVERS_INCREMENTAL, event_driven=event_driven,
+                neighbor_only=propagation == PROPAGATE_NEIGHBOR, batch=schedule == SCHEDULE_BATCH,
+                mapped_bitmap=tracker == burned_pads.MMAP,
+                intervals=tracker == burned_pads.INTERVALS)
+
+
+def _check_sharded(m, d, shards, coalesce, movers, adaptive, telemetry, checkpoint, traffic,
+                   delay_model, profile):
+    """Rejects the options the sharded schedule cannot run with."""
+    if shards is None or not 1 <= shards <= m:
+        raise ValueError(f"schedule='sharded' needs 1 <= shards <= m, got shards={shards}")
+    if d < 1:
+        raise ValueError("the sharded schedule needs d >= 1")
+    if coalesce or movers != MOVERS_SCAN or adaptive:
+        raise ValueError("the sharded schedule runs without coalesce, incremental movers "
+                         "or adaptive thresholds")
+    if any(option is not None for option in (telemetry, checkpoint, traffic, profile)):
+        raise ValueError("sharded runs take no telemetry, checkpoint, traffic or profile")
+    if isinstance(delay_model, delays.TraceDelay):
+        raise ValueError("sharded runs cannot replay a delay trace")
+
+
+def _link_delay(d, link_delay, delay_model=None):
+    """Validated worst link delay of a run; None means the configured d."""
+    if link_delay is not None and delay_model is not None:
+        raise ValueError("pass either link_delay or delay_model")
+    if delay_model is not None:
+        return delay_model.max_delay
+    if link_delay is None:
+        return d
+    if link_delay < 0:
+        raise ValueError(f"link_delay must be non-negative, got {link_delay}")
+    return link_delay
+
+
+def _native_delays(link_delay, delay_model):
+    """ring_native arguments selecting the delay model of a run."""
+    if delay_model is None or isinstance(delay_model, delays.UniformDelay):
+        return {"link_delay": link_delay}
+    if isinstance(delay_model, delays.TableDelay):
+        return {"delay_cdf": [delay_model.cdf]}
+    if isinstance(delay_model, delays.LinkDelay):
+        return {"delay_cdf": delay_model.rows}
+    if isinstance(delay_model, delays.TraceDelay):
+        return {"delay_trace": delay_model.path}
+    raise TypeError(f"the native core cannot draw from {type(delay_model).__name__}")
+
+
+def _native_result(result, with_stats):
+    if with_stats:
+        waste, counters = result
+        return waste, ScenarioStats(**counters)
+    return result
+
+
+def closed_form_waste(n, m, d, x):
+    """
+    Waste of the configurations whose outcome does not depend on the random
+    schedule, or None when the simulation is needed. Valid for every
+    run_scenario option, since none of them changes the waste.
+
+    - x=0: only active parties burn pads, so all n stay unused.
+    - m=1: the party's front neighbour is itself and its own view never
+      changes, so it never moves and only its starting pad is burned.
+    - x=1, d>=1: a party only moves with more than d pads before its front
+      neighbour, so no two parties ever share an index and the gaps around
+      the ring sum to n. No party can move only once every gap is at most d,
+      which needs n <= m*d, so the run never stops early: the lone sender
+      burns fresh pads (it never catches up with its own) until m*d are
+      left, or stays at its starting pad if n - m*d <= 1.
+
+    d=0 has no closed form: parties may then land on the same index and the
+    run can stop early, with a waste that depends on the order of moves.
+    """
+    if not (n >= 1 and m >= 1 and d >= 0 and 0 <= x <= m):
+        return None
+    if x == 0:
+        return n
+    if m == 1:
+        return n - x
+    if x == 1 and d >= 1:
+        return min(n - 1, m * d)
+    return None
+
+
+def run_scenario(n, m, d, x, backend=None, coalesce=False, tracker=burned_pads.BITSET,
+                 drift=DRIFT_STEP, rng=None, seed=None, movers=MOVERS_SCAN, event_driven=False,
+                 propagation=PROPAGATE_BROADCAST, schedule=SCHEDULE_SINGLE, telemetry=None,
+                 checkpoint=None, checkpoint_every=CHECKPOINT_EVERY, with_stats=False,
+                 fast_path=True, adaptive=False, link_delay=None, delay_model=None,
+                 traffic=None, shards=None, profile=None):
     """
     Simulation loop for a specific ring configuration.
     1. Initializes party positions and categorizes as 'Active' and 'Silent' parties.
-    2. Uses a burned set to track used OTPs
+    2. Uses a burned-pad tracker (a bitset by default) to track used OTPs
     3. Moves are categorized into three types:
         - 'Data': Active senders consume fresh pads if the gap is safe
         - 'Drift': Senders skip used pads to find fresh ones
@@ -65,90 +532,494 @@ def run_scenario(n, m, d, x):
     4. Terminates when a 'Clinch' state is reached, i.e., no one can move and no broadcasts
     are pending.
 
-    Returns the count of unused pads.
+    Randomness comes from rng (any random.Random-like object), from a fresh
+    rng.Pcg32(seed) when seed is given, or else from the global random module.
+
+    The backend ('python' or 'native') defaults to the RING_SIM_BACKEND
+    environment variable, falling back to the pure Python simulation. The native
+    core implements the same rules on a Pcg32 stream: a Pcg32 rng is advanced
+    exactly as the Python backend would advance it, so both backends return
+    the same result for the same seed; any other rng (including the global
+    random module) seeds a Pcg32, so random.seed() keeps runs reproducible.
+
+    coalesce=True delivers position updates in latest-position-wins mode (see
+    AsynchronousNetwork); it must not change the waste.
+
+    tracker picks the burned-pad structure (see burned_pads.TRACKERS). The
+    native core uses a bitset for 'set' and 'bitset', held in RAM unless
+    tracker='mmap' asks for the memory-mapped one; 'mmap' models pools
+    larger than RAM, such as n=10**11, with only the pages near the party
+    pointers resident. tracker='intervals' keeps sorted runs of burned pads
+    on both backends: memory scales with the number of runs rather than n,
+    which pays off for very large n and few parties.
+
+    drift='skip' lets an active sender cross a burned run in a single Drift:
+    it stops just before the next fresh pad, or at the furthest index its
+    view of the front neighbour allows (gap > d), and broadcasts once. The
+    default 'step' drifts one pad per tick.
+
+    movers='incremental' keeps the legal senders and jumpers in LegalMovers
+    sets instead of re-evaluating every party each tick. A party's legality
+    only changes when it moves or when its view of the front neighbour is
+    updated, so a tick costs O(1) in m. Selection order differs from 'scan',
+    so individual runs differ while the waste does not.
+
+    event_driven=True jumps the clock straight to the next delivery whenever
+    no party can move while broadcasts are in flight. Nothing can change in
+    the skipped ticks, so results are identical to tick-by-tick stepping.
+
+    propagation='neighbor' delivers each position update only to the sender's
+    ring predecessor (see AsynchronousNetwork). Only that party's view of the
+    sender is ever read, so results are identical to the default 'broadcast'.
+
+    schedule='batch' lets every legal party, active or silent, move in the
+    same tick, as concurrent senders would. Parties whose next indices
+    coincide conflict; starting from a random rotation of the legal movers,
+    the first one claims the index and the others wait for a later tick.
+    Data moves still go through the pad reuse check, and the tick stops
+    handing out moves once only m*d pads are left, as the loop would. The
+    default 'single' moves one party per tick.
+
+    schedule='sharded' splits the ring into `shards` contiguous arcs of
+    parties, party 1 + s*m//shards up to (s+1)*m//shards in shard s. Every
+    tick each shard moves all of its legal parties, from a rotation drawn
+    by the shard's own generator (Pcg32(rng.getrandbits(64), stream=s),
+    drawn after the active parties), which also draws the delays of the
+    shard's updates. Updates go to the ring predecessor alone, so only the
+    first party of an arc talks to another shard, and stale ones are
+    dropped (AsynchronousNetwork's drop_stale), so no party ever passes its
+    front neighbour. The native core runs one thread per shard once the
+    delay model never draws below 2 ticks, and all shards on one thread
+    otherwise (see src/native/sharded.hpp); both backends give the same
+    results, which do not depend on thread timing. Needs d >= 1 and
+    excludes coalesce, movers='incremental', adaptive, telemetry,
+    checkpoints, traffic, profiles and delay traces.
+
+    telemetry, a telemetry.TelemetryBuffer, receives one event per move and
+    per tick in which nobody could move; the buffer is flushed when the run
+    ends, including on a security failure. Left as None, the loop pays one
+    comparison per move.
+
+    checkpoint names a snapshot file for long native runs: if it exists the
+    run resumes from it, otherwise starts afresh; a new snapshot is written
+    every checkpoint_every loop iterations and the file is removed when the
+    run ends. A resumed run finishes exactly as an uninterrupted one would.
+    The Python backend and the 'intervals' tracker do not support checkpoints.
+
+    With fast_path (the default), configurations that closed_form_waste()
+    solves, such as the common x=1 case, return the waste without running
+    the simulation and without drawing from rng. Runs with with_stats,
+    telemetry, a checkpoint, adaptive or a profile, or with fast_path=False,
+    always simulate. On the native backend fast_path also runs m in
+    {2, 3, 4, 8} on kernels specialized for that m (see
+    ring_native.fixed_kernel for the options they cover), with the same
+    results and generator state as the generic engine; profiled runs take
+    the generic engine.
+
+    link_delay is the worst delivery delay, in ticks, that the links
+    actually show: each update is delayed by a uniform draw from
+    [0, link_delay]. It defaults to d, the worst case the safety buffer is
+    sized for. adaptive=True lets every party size its own gap threshold
+    from the delays it observes (see PartyState.track_delays), capped at d,
+    and ends the run once only the sum of the current thresholds is left
+    instead of m*d. On links faster than d most of the buffer is released.
+
+    delay_model, a model from src/delays.py, replaces the uniform draw
+    altogether: geometric or heavy-tailed delays, per-link matrices, or the
+    replay of a recorded trace. It excludes link_delay; its max_delay plays
+    that role. Both backends draw the same delays from the same Pcg32.
+    Checkpoints need adaptive=False and uniform delays over [0, d].
+
+    traffic, a traffic.Workload for the m parties, replaces the saturated
+    S.x senders with arrival processes: x must equal the number of parties
+    with a process (len(traffic.senders)), whose starting pads are burned.
+    A sender whose queue holds messages moves like an active party and
+    spends one message per Data move; with an empty queue it yields like a
+    silent one. The run also ends once the workload has no messages left to
+    deliver, and traffic.report() then gives per-message queueing latency
+    percentiles. Traffic runs always simulate and cannot be checkpointed.
+
+    profile, a profiling.Profile, collects the wall time (and hardware
+    counters, where permitted) of the native loop's phases over one
+    iteration in every profile.every; the run itself is unchanged and takes
+    the generic engine. Only the native backend can be profiled.
+
+    Returns the count of unused pads, or (unused pads, ScenarioStats) when
+    with_stats is set.
     """
-    network = AsynchronousNetwork(d)
+    backend = backend or os.environ.get("RING_SIM_BACKEND", "python")
+    if backend not in BACKENDS:
+        raise ValueError(f"unknown backend {backend!r}, expected one of {BACKENDS}")
+    flags = _native_flags(coalesce, drift, movers, event_driven, propagation, schedule, tracker)
+    link_delay = _link_delay(d, link_delay, delay_model)
+    if schedule == SCHEDULE_SHARDED:
+        _check_sharded(m, d, shards, coalesce, movers, adaptive, telemetry, checkpoint, traffic,
+                       delay_model, profile)
+    elif shards is not None:
+        raise ValueError("shards needs schedule='sharded'")
+    if traffic is not None and (traffic.m != m or x != len(traffic.senders)):
+        raise ValueError(f"traffic for {traffic.m} parties with {len(traffic.senders)} senders "
+                         f"does not match m={m}, x={x}")
+    if profile is not None and backend != "native":
+        raise ValueError("profiles need the native backend")
+    if (fast_path and not with_stats and telemetry is None and checkpoint is None
+            and not adaptive and traffic is None and profile is None):
+        waste = closed_form_waste(n, m, d, x)
+        if waste is not None:
+            return waste
+    rng = make_rng(rng, seed)
+    if backend == "native":
+        if checkpoint is not None and tracker == burned_pads.INTERVALS:
+            raise ValueError("checkpoints need a bitset burned-pad tracker")
+        native_delays = _native_delays(link_delay, delay_model)
+        if checkpoint is not None and (adaptive or native_delays != {"link_delay": d}):
+            raise ValueError("checkpoints need adaptive=False and uniform delays over [0, d]")
+        if checkpoint is not None and traffic is not None:
+            raise ValueError("traffic runs cannot be checkpointed")
+        if not isinstance(rng, Pcg32):
+            rng = Pcg32(rng.getrandbits(64))
+        result = ring_native.run_scenario(n, m, d, x, rng, with_stats=with_stats,
+                                          telemetry=telemetry, checkpoint=checkpoint,
+                                          checkpoint_every=checkpoint_every, adaptive=adaptive,
+                                          traffic=traffic, shards=shards or 0,
+                                          fixed_kernels=fast_path, profile=profile,
+                                          **native_delays, **flags)
+        return _native_result(result, with_stats)
+    if checkpoint is not None:
+        raise ValueError("checkpoints need the native backend")
+
+    sharded = schedule == SCHEDULE_SHARDED
+    network = AsynchronousNetwork(link_delay, coalesce=coalesce, rng=rng,
+                                  propagation=PROPAGATE_NEIGHBOR if sharded else propagation,
+                                  delay_model=delay_model, drop_stale=sharded)
     all_ids = list(range(1, m + 1))
-    active_ids = random.sample(all_ids, x)
+    workload = traffic
+    if workload is None:
+        active_ids = rng.sample(all_ids, x)
+        active_set = set(active_ids)
+    else:
+        # Senders are active while their queue holds messages
+        active_ids = list(workload.senders)
+        active_set = set()
+        became_busy = []
     silent_ids = [i for i in all_ids if i not in active_ids]
-    parties = {i: RingParty(i, n, m, d) for i in range(1, m + 1)}
+    parties = PartyState(n, m, d)
+    if adaptive:
+        parties.track_delays(min(d, network.d_delay))
+    my_index, views, pads_used = parties.my_index, parties.views, parties.pads_used
+    thresholds = parties.thresholds
 
     # Initially, we only burn the starting positions of the ACTIVE IDs to track progress
-    burned = set(parties[pid].my_index for pid in active_ids)
+    burned = burned_pads.make_burned(tracker, n, (my_index[pid - 1] for pid in active_ids))
+    touch = getattr(burned, "touch", None)  # page read-ahead of a mapped bitset
     MAX_UTILIZATION = n - (m * d)
+    # Slot of each party's view of its front neighbour in the flat view matrix
+    front_slot = [0] + [(p_id - 1) * m + p_id % m for p_id in range(1, m + 1)]
 
-    while len(burned) < MAX_UTILIZATION:
-        network.tick(parties)
-
-        def get_move_status(p_id):
-            """
-            Returns:
-            'data' if next pad is fresh and gap is safe.
-            'drift' if next pad is burned but gap is safe.
-            None if gap is unsafe (blocked by neighbor).
-            """
-            p = parties[p_id]
-            front_id = (p.party_id % m) + 1
-            neighbor_pos = p.view_of_others[front_id]
-
-            gap = (neighbor_pos - p.my_index) % n
-            next_idx = (p.my_index + 1) % n
-
-            if gap > d:
-                if next_idx not in burned:
-                    return 'data', next_idx
-                else:
-                    return 'drift', next_idx
-            return None, None
+    status_evaluations = 0
 
-        moved_in_tick = False
+    def get_move_status(p_id):
+        """
+        Returns:
+        'data' if next pad is fresh and gap is safe.
+        'drift' if next pad is burned but gap is safe.
+        None if gap is unsafe (blocked by neighbor).
+        """
+        nonlocal status_evaluations
+        status_evaluations += 1
+        pos = my_index[p_id - 1]
+        gap = (views[front_slot[p_id]] - pos) % n
+        next_idx = (pos + 1) % n
 
-        # 1. Priority: Active senders
-        # They either encrypt (burn) or drift (skip burned pads)
-        legal_senders = [pid for pid in active_ids if get_move_status(pid)[0] is not None]
-        if legal_senders:
-            sid = random.choice(legal_senders)
-            status, nxt = get_move_status(sid)
+        if gap > thresholds[p_id - 1]:
+            if next_idx not in burned:
+                return 'data', next_idx
+            else:
+                return 'drift', next_idx
+        return None, None
+
+    def skip_target(p_id):
+        """Furthest Drift target: just before the next fresh pad, within the safe gap."""
+        pos = my_index[p_id - 1]
+        gap = (views[front_slot[p_id]] - pos) % n
+        fresh = burned.next_unburned((pos + 1) % n)
+        run = n if fresh is None else (fresh - 1 - pos) % n
+        return (pos + min(run, gap - thresholds[p_id - 1])) % n
+
+    def reused(idx):
+        """This is a 'Loud Fail' - it proves a security breach occurred."""
+        if telemetry is not None:
+            telemetry.flush()
+        return RuntimeError(f"CRITICAL SECURITY FAILURE: Pad index {idx} reused!")
+
+    incremental = movers == MOVERS_INCREMENTAL
+    if incremental:
+        legal_active, legal_silent = LegalMovers(), LegalMovers()
+        group = {pid: legal_active for pid in active_set}
+        group.update({pid: legal_silent for pid in all_ids if pid not in active_set})
+        updated_senders = []
+
+        def refresh(p_id):
+            group[p_id].update(p_id, get_move_status(p_id)[0] is not None)
+
+        for pid in all_ids:
+            refresh(pid)
+
+    def take(pid):
+        """Spends a queued message of pid; an emptied queue makes it idle."""
+        if workload.take(pid, network.current_time):
+            active_set.discard(pid)
+            if incremental:
+                legal_active.update(pid, False)
+                group[pid] = legal_silent
+
+    if workload is not None:
+        workload.reset(rng)
+    if sharded:
+        shard_bounds = [(1 + s * m // shards, (s + 1) * m // shards) for s in range(shards)]
+        shard_rngs = [Pcg32(rng.getrandbits(64), stream=s) for s in range(shards)]
 
-            parties[sid].my_index = nxt
+    iterations = 0
+    move_counts = [0, 0, 0, 0]  # indexed by telemetry move code
+
+    def move_party(pid, status, nxt):
+        """Moves pid to nxt, or past a burned run, and broadcasts it (batch schedules)."""
+        move = YIELD
+        if pid in active_set:
+            move = DATA if status == 'data' else DRIFT
+            if status == 'drift' and drift == DRIFT_SKIP:
+                nxt = skip_target(pid)
             if status == 'data':
                 if nxt in burned:
-                    # This is a 'Loud Fail' - it proves a security breach occurred
-                    raise RuntimeError(f"CRITICAL SECURITY FAILURE: Pad index {nxt} reused!")
+                    raise reused(nxt)
                 burned.add(nxt)
-                parties[sid].pads_used += 1
+                pads_used[pid - 1] += 1
+                if workload is not None:
+                    take(pid)
+        my_index[pid - 1] = nxt
+        if touch is not None:
+            touch(pid, nxt)
+        network.send_broadcast(pid, nxt)
+        move_counts[move] += 1
+        if telemetry is not None:
+            telemetry.record(network.current_time, pid, move, nxt, network.pending)
+        if incremental:
+            refresh(pid)
+    network_s = moves_s = 0.0
+    clock = time.perf_counter
+    # Without a sender no pad is ever burned, and silent parties would yield forever
+    while len(burned) < MAX_UTILIZATION and active_ids:
+        iterations += 1
+        if with_stats:
+            started = clock()
+        if incremental:
+            network.tick(parties, on_update=updated_senders.append)
+            # Only the ring predecessor of a sender reads its position
+            for sender_id in updated_senders:
+                refresh((sender_id - 2) % m + 1)
+            updated_senders.clear()
+        else:
+            network.tick(parties)
+        if adaptive:
+            MAX_UTILIZATION = n - parties.reserve
+        if workload is not None:
+            workload.arrive(network.current_time, rng, became_busy)
+            for pid in became_busy:
+                active_set.add(pid)
+                if incremental:
+                    legal_silent.update(pid, False)
+                    group[pid] = legal_active
+                    refresh(pid)
+            became_busy.clear()
+        if with_stats:
+            delivered_at = clock()
+            network_s += delivered_at - started
 
-            # Broadcast the new position regardless of whether it was data or drift
-            network.send_broadcast(sid, nxt)
-            moved_in_tick = True
+        moved_in_tick = False
+
+        if schedule == SCHEDULE_BATCH:
+            # Every legal party moves, unless an earlier mover claimed its next index
+            if incremental:
+                legal = legal_active.ids + legal_silent.ids
+            else:
+                legal = [pid for pid in all_ids if get_move_status(pid)[0] is not None]
+            if legal:
+                start = rng.randrange(len(legal))
+                claimed = set()
+                for pid in legal[start:] + legal[:start]:
+                    if len(burned) >= MAX_UTILIZATION:
+                        break
+                    status, nxt = get_move_status(pid)
+                    if nxt in claimed:
+                        continue
+                    claimed.add(nxt)
+                    move_party(pid, status, nxt)
+                moved_in_tick = True
+
+        elif sharded:
+            # Shards move their own legal parties one after the other; with
+            # d >= 1 no two parties share a next index, so nothing is claimed
+            for (lo, hi), shard_rng in zip(shard_bounds, shard_rngs):
+                if len(burned) >= MAX_UTILIZATION:
+                    break
+                legal = [pid for pid in range(lo, hi + 1) if get_move_status(pid)[0] is not None]
+                if not legal:
+                    continue
+                start = shard_rng.randrange(len(legal))
+                network.rng = shard_rng  # the shard's updates draw their delays too
+                for pid in legal[start:] + legal[:start]:
+                    if len(burned) >= MAX_UTILIZATION:
+                        break
+                    move_party(pid, *get_move_status(pid))
+                moved_in_tick = True
 
-        # 2. Priority: Silent parties (Always jump/drift, never burn)
         else:
-            legal_jumpers = [pid for pid in silent_ids if get_move_status(pid)[0] is not None]
-            if legal_jumpers:
-                jid = random.choice(legal_jumpers)
-                status, nxt = get_move_status(jid)
-                parties[jid].my_index = nxt
-                network.send_broadcast(jid, nxt)
+            # 1. Priority: Active senders
+            # They either encrypt (burn) or drift (skip burned pads)
+            if incremental:
+                legal_senders = legal_active.ids
+            elif workload is None:
+                legal_senders = [pid for pid in active_ids if get_move_status(pid)[0] is not None]
+            else:
+                legal_senders = [pid for pid in all_ids
+                                 if pid in active_set and get_move_status(pid)[0] is not None]
+            if legal_senders:
+                sid = rng.choice(legal_senders)
+                status, nxt = get_move_status(sid)
+                if status == 'drift' and drift == DRIFT_SKIP:
+                    nxt = skip_target(sid)
+
+                my_index[sid - 1] = nxt
+                if touch is not None:
+                    touch(sid, nxt)
+                if status == 'data':
+                    if nxt in burned:
+                        raise reused(nxt)
+                    burned.add(nxt)
+                    pads_used[sid - 1] += 1
+                    if workload is not None:
+                        take(sid)
+
+                # Broadcast the new position regardless of whether it was data or drift
+                network.send_broadcast(sid, nxt)
                 moved_in_tick = True
+                move = DATA if status == 'data' else DRIFT
+                move_counts[move] += 1
+                if telemetry is not None:
+                    telemetry.record(network.current_time, sid, move, nxt, network.pending)
+                if incremental:
+                    refresh(sid)
+
+            # 2. Priority: Silent parties (Always jump/drift, never burn)
+            else:
+                if incremental:
+                    legal_jumpers = legal_silent.ids
+                elif workload is None:
+                    legal_jumpers = [pid for pid in silent_ids
+                                     if get_move_status(pid)[0] is not None]
+                else:
+                    legal_jumpers = [pid for pid in all_ids if pid not in active_set
+                                     and get_move_status(pid)[0] is not None]
+                if legal_jumpers:
+                    jid = rng.choice(legal_jumpers)
+                    status, nxt = get_move_status(jid)
+                    my_index[jid - 1] = nxt
+                    if touch is not None:
+                        touch(jid, nxt)
+                    network.send_broadcast(jid, nxt)
+                    moved_in_tick = True
+                    move_counts[YIELD] += 1
+                    if telemetry is not None:
+                        telemetry.record(network.current_time, jid, YIELD, nxt,
+                                         network.pending)
+                    if incremental:
+                        refresh(jid)
+
+        if with_stats:
+            moves_s += clock() - delivered_at
 
         # Termination: Break if no one can move and no broadcasts are pending
-        if not moved_in_tick and not network.queue:
+        if not moved_in_tick:
+            move_counts[BLOCKED] += 1
+            if telemetry is not None:
+                telemetry.record(network.current_time, 0, BLOCKED, -1, network.pending)
+            if not network.pending:
+                break
+            if event_driven:
+                network.skip_idle()
+        if workload is not None and workload.finished():
             break
 
+    if telemetry is not None:
+        telemetry.flush()
+    if with_stats:
+        return n - len(burned), ScenarioStats(
+            ticks=network.current_time, iterations=iterations,
+            broadcasts=network.sent, delivered=network.delivered,
+            view_updates=network.view_updates,
+            data_moves=move_counts[DATA], drift_moves=move_counts[DRIFT],
+            yield_moves=move_counts[YIELD], blocked_ticks=move_counts[BLOCKED],
+            max_queue_depth=network.max_pending, status_evaluations=status_evaluations,
+            network_s=network_s, moves_s=moves_s,
+        )
     return n - len(burned)
 
 
+def run_batch(n, m, d, x, rngs, backend=None, coalesce=False, tracker=burned_pads.BITSET,
+              drift=DRIFT_STEP, movers=MOVERS_SCAN, event_driven=False,
+              propagation=PROPAGATE_BROADCAST, schedule=SCHEDULE_SINGLE, with_stats=False,
+              fast_path=True, adaptive=False, link_delay=None, delay_model=None):
+    """
+    Runs one scenario per generator in rngs, all with the same configuration,
+    and returns their results in order; each result and generator ends up as
+    run_scenario(..., rng=rngs[i]) would leave it.
+
+    The native backend runs the whole batch inside a single call, so
+    thousands of small rings cost one trip through ctypes; rngs must be
+    rng.Pcg32 generators there. The Python backend runs the scenarios one
+    after the other. fast_path, adaptive, link_delay and delay_model apply
+    as in run_scenario; every scenario replays a delay trace from its start.
+    """
+    backend = backend or os.environ.get("RING_SIM_BACKEND", "python")
+    if schedule == SCHEDULE_SHARDED:
+        raise ValueError("sharded runs go through run_scenario")
+    options = dict(coalesce=coalesce, drift=drift, movers=movers, event_driven=event_driven,
+                   propagation=propagation, schedule=schedule, with_stats=with_stats,
+                   fast_path=fast_path, adaptive=adaptive, link_delay=link_delay,
+                   delay_model=delay_model)
+    if backend == "native":
+        if not all(isinstance(rng, Pcg32) for rng in rngs):
+            raise TypeError("the native batch engine needs rng.Pcg32 generators")
+        flags = _native_flags(coalesce, drift, movers, event_driven, propagation, schedule, tracker)
+        native_delays = _native_delays(_link_delay(d, link_delay, delay_model), delay_model)
+        closed = fast_path and not with_stats and not adaptive
+        waste = closed_form_waste(n, m, d, x) if closed else None
+        if waste is not None:
+            return [waste] * len(rngs)
+        results = ring_native.run_batch(n, m, d, x, rngs, with_stats=with_stats,
+                                        adaptive=adaptive, fixed_kernels=fast_path,
+                                        **native_delays, **flags)
+        return [_native_result(result, with_stats) for result in results]
+    if backend != "python":
+        raise ValueError(f"unknown backend {backend!r}, expected one of {BACKENDS}")
+    return [run_scenario(n, m, d, x, backend=backend, rng=rng, tracker=tracker, **options)
+            for rng in rngs]
+
+
 if __name__ == "__main__":
-    for M in [3, 4]:
-        N, D = 2000, 15
-        TRIALS = 50
-        print(f"\n--- Cooperative Ring Simulation (M={M}, N={N}, D={D}) ---")
-        print(f"{'Scenario (S.x)':<15} | {'Avg Wasted Pads':<15} | {'Utilization %':<10}")
-        print("-" * 55)
-
-        for x in range(1, M + 1):
-            results = [run_scenario(N, M, D, x) for _ in range(TRIALS)]
-            avg_waste = statistics.mean(results)
-            utilization = ((N - avg_waste) / N) * 100
-            print(f"S.{x:<13} | {avg_waste:<15.2f} | {utilization:<10.2f}%")
\ No newline at end of file
+    from sweep import Sweep, grid
+
+    # Results are cached per trial in memory, and on disk under RING_SIM_CACHE if set
+    sweep = Sweep(os.environ.get("RING_SIM_CACHE") or None,
+                  seed=int(os.environ.get("RING_SIM_SEED", "0")))
+    N, D = 2000, 15
+    TRIALS = 50
+    for result in sweep.run_all(grid([N], [3, 4], [D]), TRIALS, tolerance=1.0):
+        M, x = result.cell.m, result.cell.x
+        if x == 1:
+            print(f"\n--- Cooperative Ring Simulation (M={M}, N={N}, D={D}) ---")
+            print(f"{'Scenario (S.x)':<15} | {'Avg Wasted Pads':<15} | {'Utilization %':<10}")
+            print("-" * 55)
+        utilization = ((N - result.mean) / N) * 100
+        print(f"S.{x:<13} | {result.mean:<15.2f} | {utilization:<10.2f}%"
+              f"   ({len(result.waste)} trials, +/- {result.half_width:.2f})")
@@ -0,0 +1,110 @@
+"""
+Seedable random streams for the simulation.
+
+Pcg32 is the PCG-XSH-RR 64/32 generator of O'Neill (pcg-random.org). Each
+(seed, stream) pair selects an independent sequence, so one seed can be
+split into per-trial streams, and the native core implements the same
+generator and the same bounded draws: a scenario run with a given Pcg32
+state makes identical choices on both backends.
+"""
+import random
+
+_MASK64 = (1 << 64) - 1
+_MULTIPLIER = 6364136223846793005
+
+
+class Pcg32(random.Random):
+    """random.Random backed by PCG32; randint/choice/sample have fixed, portable semantics."""
+
+    def __init__(self, seed=0, stream=0):
+        self.state = 0
+        self.inc = 1
+        super().__init__(seed)
+        self.seed(seed, stream)
+
+    def seed(self, a=0, stream=0):
+        # pcg32_srandom_r
+        self.inc = ((stream << 1) | 1) & _MASK64
+        self.state = 0
+        self.next32()
+        self.state = (self.state + (int(a) & _MASK64)) & _MASK64
+        self.next32()
+        self.gauss_next = None
+
+    def split(self, stream):
+        """An independent generator on another stream, seeded from this one."""
+        return Pcg32(self.getrandbits(64), stream)
+
+    def getstate(self):
+        return self.state, self.inc
+
+    def setstate(self, state):
+        self.state, self.inc = state
+
+    def next32(self):
+        old = self.state
+        self.state = (old * _MULTIPLIER + self.inc) & _MASK64
+        xorshifted = (((old >> 18) ^ old) >> 27) & 0xFFFFFFFF
+        rot = old >> 59
+        return ((xorshifted >> rot) | (xorshifted << ((-rot) & 31))) & 0xFFFFFFFF
+
+    def getrandbits(self, k):
+        # Same word order as CPython: least significant 32-bit word first,
+        # the last word keeps its top bits
+        result, shift = 0, 0
+        while k > 0:
+            word = self.next32()
+            if k < 32:
+                word >>= 32 - k
+            result |= word << shift
+            shift += 32
+            k -= 32
+        return result
+
+    def random(self):
+        a, b = self.next32() >> 5, self.next32() >> 6
+        return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0)
+
+    def randbelow(self, n):
+        """Uniform integer in [0, n) by rejection on n.bit_length() bits."""
+        k = n.bit_length()
+        r = self.getrandbits(k)
+        while r >= n:
+            r = self.getrandbits(k)
+        return r
+
+    _randbelow = randbelow
+
+    def randint(self, a, b):
+        if b < a:
+            raise ValueError(f"empty range for randint({a}, {b})")
+        return a + self.randbelow(b - a + 1)
+
+    def choice(self, seq):
+        if not len(seq):
+            raise IndexError("Cannot choose from an empty sequence")
+        return seq[self.randbelow(len(seq))]
+
+    def sample(self, population, k, *, counts=None):
+        """Partial Fisher-Yates over a copy of the population."""
+        if counts is not None:
+            return super().sample(population, k, counts=counts)
+        pool = list(population)
+        n = len(pool)
+        if not 0 <= k <= n:
+            raise ValueError("Sample larger than population or is negative")
+        result = []
+        for i in range(k):
+            j = self.randbelow(n - i)
+            result.append(pool[j])
+            pool[j] = pool[n - i - 1]
+        return result
+
+
+def make_rng(rng=None, seed=None):
+    """Resolves run_scenario's rng/seed arguments; None means the global random module."""
+    if rng is not None and seed is not None:
+        raise ValueError("pass either rng or seed, not both")
+    if seed is not None:
+        return Pcg32(seed)
+    return rng if rng is not None else random
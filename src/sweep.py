@@ -0,0 +1,237 @@
+"""
+Parameter sweeps over run_scenario with an on-disk result cache.
+
+A cell is one (N, M, D, X) configuration plus its run_scenario options
+(delay model, drift mode, ...). Trial i of a cell runs on trial_rng(seed, i)
+(see trials.py), so its waste depends only on the cell, the seed, the trial
+index and the simulator code, never on the backend or the worker count.
+The cache keys every cell by exactly that and keeps the waste of each trial
+it has run. A sweep then simulates only the trials no earlier sweep ran: a
+new dimension value, more trials, or a cell whose code version changed.
+
+Cells are stored one file per key under the cache directory, column by
+column: CACHE_HEADER (magic, trial count, key length), the key as JSON,
+then the trial indices and the waste values as little-endian int64
+columns, sorted by trial. Files are replaced atomically on update.
+
+With a tolerance a cell stops early: it runs min_trials trials first and
+adds more, always the next trial indices, until the 95% confidence
+interval on its mean waste is at most +/- tolerance pads or the trial
+budget is spent. A cell whose waste never varies stops after min_trials.
+"""
+import glob
+import hashlib
+import json
+import math
+import os
+import statistics
+import struct
+import sys
+from array import array
+from collections import namedtuple
+
+try:
+    from . import ring_native
+    from . import trials as trial_runner
+except ImportError:
+    import ring_native
+    import trials as trial_runner
+
+CACHE_MAGIC = b"RINGSWP1"
+CACHE_HEADER = struct.Struct("<8sQI")  # magic, trials, key length; key and columns follow
+CONFIDENCE_Z = 1.96  # two-sided 95% normal quantile
+MIN_TRIALS = 20
+MAX_GROWTH = 4  # a cell at most quadruples its trials per round
+
+_HERE = os.path.dirname(os.path.abspath(__file__))
+# Sources that decide a trial's waste; editing one (or rebuilding the native
+# library) invalidates the cache
+_SOURCES = ("ring_sim.py", "ring_native.py", "burned_pads.py", "delays.py", "rng.py",
+            "trials.py", "native/*.cpp", "native/*.hpp")
+# run_scenario options whose results cannot be cached per trial
+_UNCACHEABLE = ("with_stats", "telemetry", "checkpoint", "checkpoint_every", "traffic", "rng",
+                "seed", "backend", "profile")
+
+Cell = namedtuple("Cell", "n m d x options")
+CellResult = namedtuple("CellResult", "cell waste mean half_width computed")
+
+_version = None
+
+
+def code_version():
+    """Digest of the simulator sources in _SOURCES and of the native library, if built."""
+    global _version
+    if _version is None:
+        digest = hashlib.sha256()
+        for pattern in _SOURCES:
+            for path in sorted(glob.glob(os.path.join(_HERE, pattern))):
+                digest.update(os.path.relpath(path, _HERE).encode())
+                with open(path, "rb") as stream:
+                    digest.update(stream.read())
+        library = ring_native.library_path()
+        if os.path.isfile(library):
+            digest.update(b"native library")
+            with open(library, "rb") as stream:
+                digest.update(stream.read())
+        _version = digest.hexdigest()[:16]
+    return _version
+
+
+def grid(ns, ms, ds, xs=None, variants=({},)):
+    """Every cell of the cross product; xs=None runs S.1 to S.M for each M."""
+    for options in variants:
+        for m in ms:
+            for n in ns:
+                for d in ds:
+                    for x in (range(1, m + 1) if xs is None else xs):
+                        yield Cell(n, m, d, x, dict(options))
+
+
+def half_width(waste):
+    if len(waste) < 2:
+        return math.inf
+    return CONFIDENCE_Z * statistics.stdev(waste) / math.sqrt(len(waste))
+
+
+def _describe(value):
+    """A JSON-able description of an option value, stable across runs."""
+    if value is None or isinstance(value, (bool, int, float, str)):
+        return value
+    if isinstance(value, (list, tuple)):
+        return [_describe(item) for item in value]
+    if isinstance(value, dict):
+        return {str(key): _describe(item) for key, item in sorted(value.items())}
+    state = {"type": type(value).__name__}
+    state.update((key, _describe(item)) for key, item in sorted(vars(value).items())
+                 if not key.startswith("_"))
+    path = getattr(value, "path", None)
+    if isinstance(path, str) and os.path.isfile(path):
+        # A replayed trace is part of the configuration
+        with open(path, "rb") as stream:
+            state["content"] = hashlib.sha256(stream.read()).hexdigest()
+    return state
+
+
+class Sweep:
+    """
+    Runs cells through trials.run_trials and caches their per-trial waste
+    in cache_dir (created if needed; None keeps the cache in memory only).
+    version defaults to code_version().
+    """
+    def __init__(self, cache_dir=None, seed=0, backend=None, workers=None, version=None):
+        if not isinstance(seed, int):
+            raise TypeError("a cached sweep needs an integer seed")
+        self.cache_dir = cache_dir
+        self.seed = seed
+        self.backend = backend
+        self.workers = workers
+        self.version = version or code_version()
+        self._memory = {}
+        if cache_dir is not None:
+            os.makedirs(cache_dir, exist_ok=True)
+
+    def key(self, cell):
+        bad = sorted(set(cell.options) & set(_UNCACHEABLE))
+        if bad:
+            raise ValueError(f"sweeps cannot cache runs with {', '.join(bad)}")
+        return json.dumps({"n": cell.n, "m": cell.m, "d": cell.d, "x": cell.x,
+                           "options": _describe(cell.options), "seed": self.seed,
+                           "version": self.version}, sort_keys=True)
+
+    def _path(self, key):
+        name = hashlib.sha256(key.encode()).hexdigest()[:32]
+        return os.path.join(self.cache_dir, name + ".col")
+
+    def cached(self, cell):
+        """trial -> waste for every cached trial of cell."""
+        key = self.key(cell)
+        if self.cache_dir is None:
+            return dict(self._memory.get(key, {}))
+        try:
+            with open(self._path(key), "rb") as stream:
+                raw = stream.read()
+        except FileNotFoundError:
+            return {}
+        if len(raw) < CACHE_HEADER.size:
+            return {}
+        magic, count, key_size = CACHE_HEADER.unpack_from(raw)
+        start = CACHE_HEADER.size + key_size
+        if magic != CACHE_MAGIC or len(raw) != start + 16 * count:
+            return {}  # written by something else; recompute
+        if raw[CACHE_HEADER.size:start].decode() != key:
+            return {}  # digest collision
+        trials, waste = array("q"), array("q")
+        trials.frombytes(raw[start:start + 8 * count])
+        waste.frombytes(raw[start + 8 * count:])
+        if sys.byteorder == "big":
+            trials.byteswap()
+            waste.byteswap()
+        return dict(zip(trials, waste))
+
+    def _store(self, cell, results):
+        key = self.key(cell)
+        if self.cache_dir is None:
+            self._memory[key] = dict(results)
+            return
+        order = sorted(results)
+        trials = array("q", order)
+        waste = array("q", (results[trial] for trial in order))
+        if sys.byteorder == "big":
+            trials.byteswap()
+            waste.byteswap()
+        path = self._path(key)
+        scratch = f"{path}.{os.getpid()}.tmp"
+        encoded = key.encode()
+        with open(scratch, "wb") as stream:
+            stream.write(CACHE_HEADER.pack(CACHE_MAGIC, len(order), len(encoded)))
+            stream.write(encoded)
+            trials.tofile(stream)
+            waste.tofile(stream)
+        os.replace(scratch, path)
+
+    def _ensure(self, cell, results, count):
+        """Simulates the trials below count missing from results; returns how many."""
+        computed, trial = 0, 0
+        while trial < count:
+            if trial in results:
+                trial += 1
+                continue
+            end = trial
+            while end < count and end not in results:
+                end += 1
+            waste = trial_runner.run_trials(cell.n, cell.m, cell.d, cell.x, end - trial,
+                                            seed=self.seed, workers=self.workers,
+                                            backend=self.backend, first=trial, **cell.options)
+            results.update(zip(range(trial, end), waste))
+            computed += end - trial
+            trial = end
+        if computed:
+            self._store(cell, results)
+        return computed
+
+    def run(self, cell, trials, tolerance=None, min_trials=MIN_TRIALS):
+        """
+        Runs trials 0 .. trials - 1 of cell, or fewer with a tolerance, and
+        returns a CellResult: waste lists the trials used in trial order,
+        half_width is the 95% confidence half-width on their mean (inf
+        below two trials), and computed counts the trials simulated now.
+        cell is a Cell or an (n, m, d, x[, options]) tuple.
+        """
+        if not isinstance(cell, Cell):
+            cell = Cell(*cell) if len(cell) == 5 else Cell(*cell, {})
+        results = self.cached(cell)
+        count = trials if tolerance is None else min(trials, max(2, min_trials))
+        computed = 0
+        while True:
+            computed += self._ensure(cell, results, count)
+            waste = [results[trial] for trial in range(count)]
+            width = half_width(waste)
+            if tolerance is None or width <= tolerance or count == trials:
+                break
+            # The trials the current spread needs, within MAX_GROWTH of this round
+            needed = math.ceil(count * (width / tolerance) ** 2)
+            count = min(trials, max(count + 1, min(needed, MAX_GROWTH * count)))
+        return CellResult(cell, waste, statistics.fmean(waste) if waste else math.nan, width, computed)
+
+    def run_all(self, cells, trials, tolerance=None, min_trials=MIN_TRIALS):
+        return [self.run(cell, trials, tolerance, min_trials) for cell in cells]
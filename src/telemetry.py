@@ -0,0 +1,67 @@
+"""
+Per-move telemetry for run_scenario.
+
+Every event is a fixed 32-byte little-endian record (EVENT):
+
+    tick          int64   simulated clock when the event happened
+    index         int64   pad index the party moved to, -1 for BLOCKED
+    queue_depth   int32   updates in flight after the event
+    party         int32   moving party id, 0 for BLOCKED
+    move          uint8   DATA, DRIFT, YIELD or BLOCKED
+    (7 bytes padding)
+
+The layout matches ringsim_event in src/native/ring_capi.h, so both
+backends emit byte-identical streams for the same seed. Events collect in a
+preallocated buffer of `capacity` records that is handed to the sink in
+binary chunks whenever it fills, and once more when the run ends.
+"""
+import struct
+
+DATA = 0
+DRIFT = 1
+YIELD = 2     # a silent party jumped forward
+BLOCKED = 3   # nobody could move in the tick
+
+EVENT = struct.Struct("<qqiiB7x")
+
+
+class TelemetryBuffer:
+    """
+    Bounded event buffer. sink is a binary file-like object (anything with
+    write()) or a callable; either receives each flushed chunk as bytes.
+    """
+    def __init__(self, sink, capacity=4096):
+        if capacity < 1:
+            raise ValueError("telemetry capacity must be positive")
+        self.capacity = capacity
+        self.events = 0
+        self._write = sink.write if hasattr(sink, "write") else sink
+        self._buf = bytearray(capacity * EVENT.size)
+        self._used = 0
+
+    def record(self, tick, party, move, index, queue_depth):
+        EVENT.pack_into(self._buf, self._used * EVENT.size, tick, index, queue_depth, party, move)
+        self._used += 1
+        if self._used == self.capacity:
+            self.flush()
+
+    def emit(self, chunk):
+        """Passes an already encoded chunk of events (e.g. from the native core) to the sink."""
+        self.events += len(chunk) // EVENT.size
+        self._write(bytes(chunk))
+
+    def flush(self):
+        if self._used:
+            used, self._used = self._used, 0
+            self.emit(memoryview(self._buf)[:used * EVENT.size])
+
+
+def iter_events(data):
+    """Decodes a telemetry stream into (tick, party, move, index, queue_depth) tuples."""
+    for tick, index, queue_depth, party, move in EVENT.iter_unpack(data):
+        yield tick, party, move, index, queue_depth
+
+
+def read_events(path):
+    with open(path, "rb") as stream:
+        return list(iter_events(stream.read()))
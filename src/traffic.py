@@ -0,0 +1,256 @@
+"""
+Workload-driven senders for run_scenario(..., traffic=Workload(...)).
+
+Instead of a fixed set of always-busy active parties, every party owns a
+send queue fed by an arrival process. A party with queued messages takes
+the Data/Drift path like an active sender and spends one message per Data
+move; a party with an empty queue yields like a silent one. The queueing
+latency of a message is the tick of the Data move that encrypts it minus
+its arrival tick, reported by Workload.report() next to the waste.
+
+Arrival processes draw from the run's generator in a fixed order (parties'
+next arrivals are scheduled in (tick, party) order), so the native core
+reproduces a Pcg32 run exactly:
+
+- PoissonArrivals(rate): exponential gaps of mean 1 / rate ticks in
+  continuous time; a message arrives at the tick its time rounds up to.
+- OnOffArrivals(rate, mean_on, mean_off): Poisson arrivals at `rate`
+  during on periods, none during off periods; both period lengths are
+  exponential with the given means, starting with an on period at tick 0.
+- Workload.from_trace(path, m): replays recorded (tick, party) messages
+  from a trace file (see write_message_trace), streamed in chunks.
+"""
+import heapq
+import math
+import statistics
+import struct
+from array import array
+from collections import deque
+
+TRACE_MAGIC = b"RINGMSG1"
+# magic, record count, parties, reserved; MESSAGE records follow in tick order
+TRACE_HEADER = struct.Struct("<8sQII")
+MESSAGE = struct.Struct("<qi")  # arrival tick, party id
+TRACE_CHUNK = 65_536  # records read per refill
+
+POISSON = 1  # process kinds, as ringsim_arrivals.kind in src/native/ring_capi.h
+ON_OFF = 2
+
+
+def _exponential(rng, rate):
+    return -math.log(1.0 - rng.random()) / rate
+
+
+class PoissonArrivals:
+    kind = POISSON
+
+    def __init__(self, rate):
+        if rate <= 0:
+            raise ValueError(f"arrival rate must be positive, got {rate}")
+        self.rate = rate
+        self.mean_on = self.mean_off = 0.0
+
+    def reset(self):
+        self._t = 0.0
+
+    def next_arrival(self, rng):
+        self._t += _exponential(rng, self.rate)
+        return math.ceil(self._t)
+
+
+class OnOffArrivals:
+    kind = ON_OFF
+
+    def __init__(self, rate, mean_on, mean_off):
+        if rate <= 0 or mean_on <= 0 or mean_off <= 0:
+            raise ValueError("rate and mean period lengths must be positive")
+        self.rate, self.mean_on, self.mean_off = rate, mean_on, mean_off
+
+    def reset(self):
+        self._t = self._switch = 0.0
+        self._on = False
+
+    def next_arrival(self, rng):
+        while True:
+            if not self._on:
+                self._t, self._on = self._switch, True
+                self._switch = self._t + _exponential(rng, 1.0 / self.mean_on)
+            gap = _exponential(rng, self.rate)
+            if self._t + gap < self._switch:
+                self._t += gap
+                return math.ceil(self._t)
+            # The on period ends first; gaps are memoryless, so restart after it
+            self._t, self._on = self._switch, False
+            self._switch = self._t + _exponential(rng, 1.0 / self.mean_off)
+
+
+class _MessageTrace:
+    """Streams the MESSAGE records of a trace file, TRACE_CHUNK at a time."""
+    def __init__(self, path, m, chunk=TRACE_CHUNK):
+        self.path, self.chunk, self.m = path, chunk, m
+        with open(path, "rb") as stream:
+            raw = stream.read(TRACE_HEADER.size)
+        if len(raw) < TRACE_HEADER.size:
+            raise ValueError(f"not a message trace: {path}")
+        magic, self.count, parties, _ = TRACE_HEADER.unpack(raw)
+        if magic != TRACE_MAGIC or parties != m:
+            raise ValueError(f"not a message trace for {m} parties: {path}")
+        self._stream = None
+
+    def reset(self):
+        if self._stream is None:
+            self._stream = open(self.path, "rb")
+        self._stream.seek(TRACE_HEADER.size)
+        self._read = 0
+        self._records = []
+        self._next = 0
+
+    def peek(self):
+        """Next (tick, party) record, or None once the trace is exhausted."""
+        if self._next == len(self._records):
+            if self._read == self.count:
+                return None
+            records = min(self.chunk, self.count - self._read)
+            raw = self._stream.read(records * MESSAGE.size)
+            if len(raw) != records * MESSAGE.size:
+                raise ValueError(f"truncated message trace: {self.path}")
+            self._records = list(MESSAGE.iter_unpack(raw))
+            if any(not 1 <= party <= self.m for _, party in self._records):
+                raise ValueError(f"message trace names an unknown party: {self.path}")
+            self._read += records
+            self._next = 0
+        return self._records[self._next]
+
+    def pop(self):
+        self._next += 1
+
+    def close(self):
+        if self._stream is not None:
+            self._stream.close()
+            self._stream = None
+
+
+class Workload:
+    """
+    Arrival processes of the m parties of a ring: arrivals[p - 1] feeds
+    party p, None for a party that never sends. Arrivals after tick `until`
+    are dropped; the run then ends once every queue has drained, or earlier
+    when the pad runs out. Without `until`, a Poisson or on/off workload
+    runs until the pad runs out.
+
+    A Workload holds the state of one run at a time: run_scenario resets it,
+    and report() describes the latest run.
+    """
+    def __init__(self, arrivals, until=None):
+        if len({id(p) for p in arrivals if p is not None}) != sum(p is not None for p in arrivals):
+            raise ValueError("every party needs its own arrival process")
+        self.m = len(arrivals)
+        self.arrivals = list(arrivals)
+        self.until = until
+        self.senders = [pid for pid, p in enumerate(arrivals, 1) if p is not None]
+        self.trace = None
+
+    @classmethod
+    def poisson(cls, m, rate, until=None):
+        """Every party sends at the same Poisson rate."""
+        return cls([PoissonArrivals(rate) for _ in range(m)], until=until)
+
+    @classmethod
+    def from_trace(cls, path, m, until=None):
+        """Replays a message trace; every party may send."""
+        workload = cls([None] * m, until=until)
+        workload.trace = _MessageTrace(path, m)
+        workload.senders = list(range(1, m + 1))
+        return workload
+
+    def reset(self, rng):
+        """Starts a run: empty queues, first arrival of every process drawn."""
+        self.queues = [deque() for _ in range(self.m + 1)]
+        self.latencies = array("q")
+        self.arrived = self.queued = 0
+        self._heap = []
+        for pid in self.senders:
+            process = self.arrivals[pid - 1]
+            if process is not None:
+                process.reset()
+                self._schedule(pid, process.next_arrival(rng))
+        if self.trace is not None:
+            self.trace.reset()
+
+    def _schedule(self, pid, tick):
+        if self.until is None or tick <= self.until:
+            heapq.heappush(self._heap, (tick, pid))
+
+    def arrive(self, now, rng, became_busy):
+        """Queues every message due by tick now; appends parties whose queue filled."""
+        heap = self._heap
+        while heap and heap[0][0] <= now:
+            tick, pid = heapq.heappop(heap)
+            self._push(pid, tick, became_busy)
+            self._schedule(pid, self.arrivals[pid - 1].next_arrival(rng))
+        trace = self.trace
+        while trace is not None:
+            record = trace.peek()
+            if record is None or record[0] > now or (self.until is not None and record[0] > self.until):
+                break
+            trace.pop()
+            self._push(record[1], record[0], became_busy)
+
+    def _push(self, pid, tick, became_busy):
+        queue = self.queues[pid]
+        if not queue:
+            became_busy.append(pid)
+        queue.append(tick)
+        self.arrived += 1
+        self.queued += 1
+
+    def take(self, pid, now):
+        """Spends the oldest message of pid; returns True if its queue emptied."""
+        queue = self.queues[pid]
+        self.latencies.append(now - queue.popleft())
+        self.queued -= 1
+        return not queue
+
+    def finished(self):
+        if self.queued or self._heap:
+            return False
+        if self.trace is None:
+            return True
+        record = self.trace.peek()
+        return record is None or (self.until is not None and record[0] > self.until)
+
+    def report(self):
+        """Messages of the latest run and their queueing latency in ticks."""
+        ordered = sorted(self.latencies)
+
+        def pick(q):
+            return ordered[min(len(ordered) - 1, int(q * len(ordered)))] if ordered else None
+        return {
+            "arrived": self.arrived,
+            "sent": len(ordered),
+            "unsent": self.queued,
+            "latency": {"p50": pick(0.50), "p99": pick(0.99), "p999": pick(0.999),
+                        "max": ordered[-1] if ordered else None,
+                        "mean": statistics.fmean(ordered) if ordered else None},
+        }
+
+    def adopt(self, arrived, latencies):
+        """Takes over the outcome of a native run (see ring_native.run_scenario)."""
+        self.arrived, self.latencies = arrived, latencies
+        self.queued = arrived - len(latencies)
+
+    def close(self):
+        if self.trace is not None:
+            self.trace.close()
+
+
+def write_message_trace(path, messages, m):
+    """Writes (tick, party) messages, sorted by tick, as a trace for m parties."""
+    messages = sorted(messages)
+    with open(path, "wb") as stream:
+        stream.write(TRACE_HEADER.pack(TRACE_MAGIC, len(messages), m, 0))
+        for tick, party in messages:
+            if not 1 <= party <= m:
+                raise ValueError(f"party {party} outside 1..{m}")
+            stream.write(MESSAGE.pack(tick, party))
+    return path
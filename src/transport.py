@@ -0,0 +1,306 @@
+"""
+Real transports for the position updates that AsynchronousNetwork simulates.
+
+Parties run as separate processes (or hosts) and exchange fixed-size binary
+frames (FRAME, 32 bytes little-endian):
+
+    sender_id   int64   party that moved
+    index       int64   its new position, FIN once it has stopped for good
+    sequence    uint64  per-sender frame counter, starting at 0
+    sent_ns     int64   time.monotonic_ns() at the sender
+
+Both transports mirror the simulated network API: send_broadcast(sender_id,
+index) publishes a position and poll(party) applies every frame received
+since the last call through party.update_view. Frames are decoded in place
+from the shared buffer or the receive buffer, never copied into bytes.
+
+SharedMemoryTransport keeps one single-writer ring buffer per sender in a
+multiprocessing.shared_memory block, for parties on one host. UdpTransport
+sends each frame as one UDP multicast datagram, for parties across hosts;
+sent_ns then only yields meaningful latencies between parties that share a
+clock. measure_latency() runs a ring of party processes over either one.
+"""
+import multiprocessing
+import socket
+import statistics
+import struct
+import time
+from multiprocessing import shared_memory
+
+try:
+    from . import ring_sim
+except ImportError:
+    import ring_sim
+
+FRAME = struct.Struct("<qqQq")
+FIN = -1  # index of the last frame a party sends
+
+_HEAD = struct.Struct("<Q")  # frames written to a ring so far
+_SEQ = struct.Struct("<Q")  # sequence field of a frame in a ring, at _SEQ_OFFSET
+_SEQ_OFFSET = 16
+_WRITING = 2**64 - 1  # sequence of a ring slot while its frame is rewritten
+_RING_HEADER = 64  # head counter, padded to its own cache line
+
+
+class _Receiver:
+    """Per-transport receive bookkeeping shared by both transports."""
+    def __init__(self, m):
+        self.m = m
+        self.finished = set()  # senders whose FIN frame arrived
+        self.latencies_ns = []
+        self.lost = 0  # frames overwritten or dropped before they were read
+
+    def _apply(self, party, sender_id, index, sent_ns):
+        self.latencies_ns.append(time.monotonic_ns() - sent_ns)
+        if index == FIN:
+            self.finished.add(sender_id)
+        else:
+            party.update_view(sender_id, index)
+
+
+class SharedMemoryTransport(_Receiver):
+    """
+    One ring of `capacity` frames per sender in a shared memory block; only
+    the owning party writes to its ring, every other party reads it with its
+    own cursor. Slots are seqlocks: the writer marks a slot's sequence
+    number as being written, stores the frame, then stores its sequence
+    number and publishes the new head. Readers check the sequence number
+    before and after copying a frame, so a frame the writer overwrote while
+    it was read is discarded and counted in lost. staleness records, per
+    frame read, how many newer frames its sender had published by then.
+
+    The creating side passes create=True and unlinks the block with
+    unlink() once every party has closed it.
+    """
+    def __init__(self, name, m, capacity=1024, create=False):
+        super().__init__(m)
+        self.capacity = capacity
+        self._ring_bytes = _RING_HEADER + capacity * FRAME.size
+        if create:
+            self._shm = shared_memory.SharedMemory(name=name, create=True,
+                                                   size=m * self._ring_bytes)
+            self._shm.buf[:] = bytes(m * self._ring_bytes)
+        else:
+            self._shm = shared_memory.SharedMemory(name=name)
+        self.name = self._shm.name
+        self._buf = self._shm.buf
+        self._cursor = [0] * (m + 1)
+        self._written = [0] * (m + 1)
+        self.staleness = []
+
+    def _base(self, sender_id):
+        return (sender_id - 1) * self._ring_bytes
+
+    def send_broadcast(self, sender_id, new_index):
+        base, seq = self._base(sender_id), self._written[sender_id]
+        offset = base + _RING_HEADER + (seq % self.capacity) * FRAME.size
+        _SEQ.pack_into(self._buf, offset + _SEQ_OFFSET, _WRITING)
+        FRAME.pack_into(self._buf, offset, sender_id, new_index, _WRITING, time.monotonic_ns())
+        _SEQ.pack_into(self._buf, offset + _SEQ_OFFSET, seq)
+        _HEAD.pack_into(self._buf, base, seq + 1)
+        self._written[sender_id] = seq + 1
+
+    def poll(self, party):
+        """Applies all frames published since the last poll; returns how many."""
+        applied = 0
+        buf, capacity = self._buf, self.capacity
+        for sender_id in range(1, self.m + 1):
+            if sender_id == party.party_id:
+                continue
+            base = self._base(sender_id)
+            head = _HEAD.unpack_from(buf, base)[0]
+            seq = self._cursor[sender_id]
+            if head - seq > capacity:
+                self.lost += head - capacity - seq
+                seq = head - capacity
+            while seq < head:
+                offset = base + _RING_HEADER + (seq % capacity) * FRAME.size
+                before = _SEQ.unpack_from(buf, offset + _SEQ_OFFSET)[0]
+                _, index, _, sent_ns = FRAME.unpack_from(buf, offset)
+                if before != seq or _SEQ.unpack_from(buf, offset + _SEQ_OFFSET)[0] != seq:
+                    # Overwritten by a lap of the writer, before or while we read it
+                    head = _HEAD.unpack_from(buf, base)[0]
+                    resume = max(seq + 1, head - capacity)
+                    self.lost += resume - seq
+                    seq = resume
+                    continue
+                self.staleness.append(head - seq - 1)
+                self._apply(party, sender_id, index, sent_ns)
+                applied += 1
+                seq += 1
+            self._cursor[sender_id] = seq
+        return applied
+
+    def close(self):
+        self._buf = None
+        self._shm.close()
+
+    def unlink(self):
+        self._shm.unlink()
+
+
+class UdpTransport(_Receiver):
+    """
+    Frames as UDP multicast datagrams on (group, port). Datagrams may be
+    lost or reordered, so a frame older than the latest one applied from its
+    sender is discarded: views only ever move forward, as with coalescing
+    in the simulated network. A datagram the kernel refuses to queue is
+    dropped like one lost on the wire.
+    """
+    def __init__(self, m, group="239.255.77.77", port=47_077, ttl=1):
+        super().__init__(m)
+        self._target = (group, port)
+        self._sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+        self._sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        if hasattr(socket, "SO_REUSEPORT"):
+            self._sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEPORT, 1)
+        self._sock.bind(("", port))
+        membership = socket.inet_aton(group) + socket.inet_aton("0.0.0.0")
+        self._sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, membership)
+        self._sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, ttl)
+        self._sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_LOOP, 1)
+        self._sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4 << 20)
+        self._sock.setblocking(False)
+        self._tx = bytearray(FRAME.size)
+        self._rx = bytearray(FRAME.size)
+        self._written = [0] * (m + 1)
+        self._latest = [-1] * (m + 1)
+
+    def send_broadcast(self, sender_id, new_index):
+        seq = self._written[sender_id]
+        FRAME.pack_into(self._tx, 0, sender_id, new_index, seq, time.monotonic_ns())
+        self._written[sender_id] = seq + 1
+        try:
+            self._sock.sendto(self._tx, self._target)
+        except BlockingIOError:
+            pass
+
+    def poll(self, party):
+        applied = 0
+        while True:
+            try:
+                size = self._sock.recv_into(self._rx)
+            except BlockingIOError:
+                return applied
+            if size != FRAME.size:
+                continue
+            sender_id, index, seq, sent_ns = FRAME.unpack_from(self._rx)
+            if sender_id == party.party_id or not 1 <= sender_id <= self.m:
+                continue
+            if seq <= self._latest[sender_id]:
+                self.lost += 1
+                continue
+            self.lost += seq - self._latest[sender_id] - 1
+            self._latest[sender_id] = seq
+            self._apply(party, sender_id, index, sent_ns)
+            applied += 1
+
+    def close(self):
+        self._sock.close()
+
+
+def _open(kind, m, shm_name, capacity):
+    if kind == "shm":
+        return SharedMemoryTransport(shm_name, m, capacity=capacity)
+    if kind == "udp":
+        return UdpTransport(m)
+    raise ValueError(f"unknown transport {kind!r}, expected 'shm' or 'udp'")
+
+
+def _party_process(party_id, n, m, d, moves, kind, shm_name, capacity, idle_s, barrier,
+                   results):
+    """
+    One party of the ring: it takes a step whenever its view of the front
+    neighbour leaves a gap of more than d, as the simulated move rule does,
+    until it made `moves` steps or is blocked behind a party that finished.
+    It leaves once every other party finished, or after idle_s seconds
+    without a frame, which covers FIN frames lost over UDP.
+    """
+    transport = _open(kind, m, shm_name, capacity)
+    party = ring_sim.RingParty(party_id, n, m, d)
+    front = party_id % m + 1
+    barrier.wait()
+    moved = 0
+    finished = False
+    heard = time.monotonic()
+    while not finished or len(transport.finished) < m - 1:
+        if transport.poll(party):
+            heard = time.monotonic()
+        elif time.monotonic() - heard > idle_s:
+            break
+        if finished:
+            time.sleep(0)
+            continue
+        gap = (party.view_of_others[front] - party.my_index) % n
+        if moved < moves and gap > d:
+            party.my_index = (party.my_index + 1) % n
+            transport.send_broadcast(party_id, party.my_index)
+            moved += 1
+        elif moved == moves or front in transport.finished:
+            transport.send_broadcast(party_id, FIN)
+            finished = True
+        else:
+            time.sleep(0)
+    staleness = getattr(transport, "staleness", [])
+    results.put((party_id, moved, transport.latencies_ns, staleness, transport.lost))
+    transport.close()
+
+
+def _percentiles(samples):
+    if not samples:
+        return {"p50": None, "p99": None, "max": None}
+    ordered = sorted(samples)
+
+    def pick(q):
+        return ordered[min(len(ordered) - 1, int(q * len(ordered)))]
+    return {"p50": pick(0.50), "p99": pick(0.99), "max": ordered[-1]}
+
+
+def measure_latency(n, m, d, moves=1000, transport="shm", capacity=1024, idle_s=2.0):
+    """
+    Runs m party processes on one ring over a real transport and returns the
+    observed coordination delay: per-frame latency percentiles in
+    microseconds and, over shared memory, how many newer updates a sender
+    had published by the time each frame was read. That staleness is what
+    the safety buffer d has to cover in a deployment.
+    """
+    ctx = multiprocessing.get_context()
+    shm = None
+    if transport == "shm":
+        shm = SharedMemoryTransport(None, m, capacity=capacity, create=True)
+    try:
+        barrier, results = ctx.Barrier(m), ctx.Queue()
+        procs = [ctx.Process(target=_party_process,
+                             args=(pid, n, m, d, moves, transport, shm and shm.name, capacity,
+                                   idle_s, barrier, results))
+                 for pid in range(1, m + 1)]
+        for proc in procs:
+            proc.start()
+        outcomes = [results.get() for _ in procs]
+        for proc in procs:
+            proc.join()
+    finally:
+        if shm is not None:
+            shm.close()
+            shm.unlink()
+    latencies = [ns / 1000 for _, _, lat, _, _ in outcomes for ns in lat]
+    staleness = [s for _, _, _, stale, _ in outcomes for s in stale]
+    report = {
+        "transport": transport, "n": n, "m": m, "d": d,
+        "moves": {pid: moved for pid, moved, _, _, _ in outcomes},
+        "frames": len(latencies),
+        "lost": sum(lost for *_, lost in outcomes),
+        "latency_us": _percentiles(latencies),
+        "staleness": _percentiles(staleness),
+    }
+    if latencies:
+        report["latency_us"]["mean"] = statistics.fmean(latencies)
+    return report
+
+
+if __name__ == "__main__":
+    import json
+    import sys
+
+    kind = sys.argv[1] if len(sys.argv) > 1 else "shm"
+    print(json.dumps(measure_latency(2000, 4, 15, transport=kind), indent=2))
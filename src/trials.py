@@ -0,0 +1,70 @@
+"""
+Multi-trial runner: spreads independent run_scenario trials over a worker pool.
+
+Trial i always runs on its own PCG stream, trial_rng(seed, i), whichever
+worker picks it up, and results come back in trial order, so aggregate
+statistics do not depend on the number of workers (nor on the backend, which
+draws identically from the stream). The Python backend uses processes (the
+simulation holds the GIL); the native backend uses threads, since ctypes
+releases the GIL for the duration of each native call, and each thread
+hands its trials to the native batch engine (ring_sim.run_batch) in chunks
+of up to BATCH_SIZE.
+"""
+import os
+import random
+from concurrent.futures import ProcessPoolExecutor, ThreadPoolExecutor
+
+try:
+    from . import ring_sim
+    from .rng import Pcg32
+except ImportError:
+    import ring_sim
+    from rng import Pcg32
+
+BATCH_SIZE = 256
+
+
+def trial_rng(seed, trial):
+    """The independent generator of one trial: stream `trial` of the run seed."""
+    return Pcg32(seed, stream=trial)
+
+
+def _trial(job):
+    n, m, d, x, seed, trial, backend, options = job
+    return ring_sim.run_scenario(n, m, d, x, backend=backend, rng=trial_rng(seed, trial), **options)
+
+
+def _batch(job):
+    n, m, d, x, seed, trials, backend, options = job
+    rngs = [trial_rng(seed, trial) for trial in trials]
+    return ring_sim.run_batch(n, m, d, x, rngs, backend=backend, **options)
+
+
+def run_trials(n, m, d, x, trials, seed=None, workers=None, backend=None, first=0, **options):
+    """
+    Runs `trials` independent scenarios, trials first .. first + trials - 1
+    of the seed, and returns their waste values in trial order. seed
+    defaults to a draw from the global random module; workers defaults to
+    os.cpu_count(). Extra keyword options are passed to run_scenario.
+    """
+    backend = backend or os.environ.get("RING_SIM_BACKEND", "python")
+    if backend not in ring_sim.BACKENDS:
+        raise ValueError(f"unknown backend {backend!r}, expected one of {ring_sim.BACKENDS}")
+    if seed is None:
+        seed = random.getrandbits(64)
+    workers = max(1, min(workers or os.cpu_count() or 1, trials or 1))
+
+    if backend == "native":
+        size = max(1, min(BATCH_SIZE, -(-trials // workers)))
+        end = first + trials
+        jobs = [(n, m, d, x, seed, range(start, min(start + size, end)), backend, options)
+                for start in range(first, end, size)]
+        if workers == 1:
+            return [waste for job in jobs for waste in _batch(job)]
+        with ThreadPoolExecutor(max_workers=workers) as pool:
+            return [waste for chunk in pool.map(_batch, jobs) for waste in chunk]
+    jobs = [(n, m, d, x, seed, i, backend, options) for i in range(first, first + trials)]
+    if workers == 1:
+        return [_trial(job) for job in jobs]
+    with ProcessPoolExecutor(max_workers=workers) as pool:
+        return list(pool.map(_trial, jobs, chunksize=max(1, trials // (4 * workers))))
@@ -0,0 +1,26 @@
+import os
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src import ring_native
+
+
+def pytest_configure(config):
+    config.addinivalue_line("markers", "needs_native: skipped unless the native core is built")
+
+
+def pytest_collection_modifyitems(config, items):
+    if ring_native.available():
+        return
+    skip = pytest.mark.skip(reason="native core not built")
+    for item in items:
+        if "needs_native" in item.keywords:
+            item.add_marker(skip)
+
+
+@pytest.fixture(params=["python", pytest.param("native", marks=pytest.mark.needs_native)])
+def backend(request):
+    """Runs a test once per backend; the native run carries needs_native."""
+    return request.param
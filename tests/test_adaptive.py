@@ -0,0 +1,85 @@
+import os
+import random
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src import ring_native
+from src.ring_sim import AsynchronousNetwork, DelayEstimator, PartyState, run_batch, run_scenario
+from src.rng import Pcg32
+
+
+def test_estimator_tracks_the_percentile_and_forgets_old_delays():
+    est = DelayEstimator(10, percentile=90, window=100)
+    for delay in [2] * 95 + [9] * 5:
+        est.add(delay)
+    assert est.estimate == 2
+    # A slower link shows within a few windows
+    for _ in range(300):
+        est.add(6)
+    assert est.estimate == 6
+    assert est.add(50) == 6 and est.counts[10] == 1
+
+
+def test_thresholds_follow_front_neighbour_delays():
+    state = PartyState(300, 3, 5)
+    state.track_delays(5)
+    net = AsynchronousNetwork(1, rng=random.Random(0))
+    for _ in range(99):
+        net.send_broadcast(2, 120)
+        net.tick(state)
+    # Too few samples to adapt yet
+    assert list(state.thresholds) == [5, 5, 5]
+    net.send_broadcast(2, 120)
+    net.tick(state)
+    # Only party 1 reads party 2's position; the others keep the worst case
+    assert list(state.thresholds) == [1, 5, 5]
+    assert state.reserve == 11
+    assert state.parties()[1].gap_threshold == 1
+    assert state.parties()[2].delay_estimator.total == 0
+
+
+def test_low_jitter_links_release_the_buffer(backend):
+    n, m, d = 2000, 4, 15
+    fixed = run_scenario(n, m, d, 1, backend=backend, seed=3, link_delay=2, fast_path=False)
+    waste = run_scenario(n, m, d, 1, backend=backend, seed=3, link_delay=2, adaptive=True)
+    assert fixed == m * d
+    assert waste <= m * 2 and (n - waste) / n > 0.99
+
+
+@pytest.mark.parametrize("options", [
+    {},
+    {"coalesce": True, "drift": "skip"},
+    {"movers": "incremental", "event_driven": True},
+    {"propagation": "neighbor", "schedule": "batch"},
+])
+@pytest.mark.needs_native
+def test_backends_agree_in_adaptive_mode(options):
+    for x, link_delay in [(1, 3), (3, 15), (4, 1)]:
+        runs = [run_scenario(3000, 4, 15, x, backend=backend, rng=Pcg32(x), adaptive=True,
+                             link_delay=link_delay, with_stats=True, **options)
+                for backend in ("python", "native")]
+        assert runs[0] == runs[1]
+    batch = run_batch(3000, 4, 15, 2, [Pcg32(1), Pcg32(2)], backend="native", adaptive=True,
+                      link_delay=2)
+    assert batch == [run_scenario(3000, 4, 15, 2, rng=Pcg32(s), adaptive=True, link_delay=2)
+                     for s in (1, 2)]
+
+
+def test_slow_links_keep_the_configured_buffer(backend):
+    # Delays beyond d saturate every estimate, so thresholds stay at d
+    fixed = run_scenario(2000, 4, 15, 3, backend=backend, rng=Pcg32(9), link_delay=40,
+                         with_stats=True)
+    adaptive = run_scenario(2000, 4, 15, 3, backend=backend, rng=Pcg32(9), link_delay=40,
+                            with_stats=True, adaptive=True)
+    assert adaptive == fixed
+
+
+def test_invalid_options_are_rejected(tmp_path):
+    with pytest.raises(ValueError):
+        run_scenario(100, 2, 5, 1, link_delay=-1)
+    if ring_native.available():
+        with pytest.raises(ValueError):
+            run_scenario(100, 2, 5, 1, backend="native", adaptive=True,
+                         checkpoint=str(tmp_path / "run.ckpt"))
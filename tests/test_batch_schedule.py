@@ -0,0 +1,37 @@
+import os
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.ring_sim import run_scenario
+from src.rng import Pcg32
+
+CASES = [(2000, 4, 15, 4), (2000, 4, 15, 1), (1000, 8, 30, 5), (600, 3, 0, 3)]
+
+
+def test_batch_schedule_keeps_waste_bounded_and_cuts_ticks(backend):
+    for n, m, d, x in CASES:
+        single, single_stats = run_scenario(n, m, d, x, backend=backend, seed=5, with_stats=True)
+        waste, stats = run_scenario(n, m, d, x, backend=backend, seed=5, schedule="batch",
+                                    with_stats=True)
+        assert waste <= m * d
+        assert stats.ticks < single_stats.ticks
+
+
+@pytest.mark.needs_native
+def test_batch_schedule_backends_agree():
+    for n, m, d, x in CASES:
+        for movers in ("scan", "incremental"):
+            results = []
+            for backend in ("python", "native"):
+                rng = Pcg32(11)
+                result = run_scenario(n, m, d, x, backend=backend, rng=rng, schedule="batch",
+                                      movers=movers, drift="skip", with_stats=True)
+                results.append((result, rng.getstate()))
+            assert results[0] == results[1]
+
+
+def test_unknown_schedule_is_rejected():
+    with pytest.raises(ValueError):
+        run_scenario(100, 2, 5, 2, backend="python", schedule="parallel")
@@ -0,0 +1,30 @@
+import json
+import os
+import sys
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from bench import bench_ring_sim
+
+
+def test_run_cell_reports_throughput_metrics():
+    record = bench_ring_sim.run_cell(400, 4, 15, 3, backend="python", trials=2, seed=1, options={})
+    json.dumps(record)
+    assert record["waste_mean"] == 60
+    assert record["ticks_per_s"] > 0 and record["delivered_per_s"] > 0
+    assert record["wall_s_min"] <= record["wall_s_mean"] <= record["wall_s_max"]
+    assert record["peak_rss_kb"] > 0
+
+
+def test_compare_flags_slower_cells():
+    cell = dict(n=400, m=4, d=15, x=3, backend="python", options={})
+    baseline = {"results": [dict(cell, ticks_per_s=1000.0)]}
+    current = {"results": [dict(cell, ticks_per_s=500.0)]}
+    assert bench_ring_sim.compare(baseline, current, threshold=0.9)
+    assert not bench_ring_sim.compare(baseline, current, threshold=0.4)
+
+
+def test_sharded_cells_take_a_delay_floor():
+    options = {"schedule": "sharded", "shards": 2, "delay_floor": 4}
+    record = bench_ring_sim.run_cell(400, 4, 15, 4, backend="python", trials=1, seed=1,
+                                     options=options)
+    assert record["options"] == options and record["waste_mean"] == 60
@@ -0,0 +1,130 @@
+import os
+import random
+import sys
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src import burned_pads
+from src.burned_pads import BurnedBitset, BurnedIntervals, BurnedSet, MappedBitset
+from src.ring_sim import run_scenario
+
+
+def test_bitset_matches_set():
+    rng = random.Random(3)
+    for n in [1, 63, 64, 65, 200, 1000]:
+        reference, bitset, mapped = BurnedSet(n), BurnedBitset(n), MappedBitset(n)
+        for _ in range(rng.randint(0, n)):
+            idx = rng.randrange(n)
+            reference.add(idx)
+            bitset.add(idx)
+            mapped.add(idx)
+        assert len(bitset) == len(mapped) == len(reference)
+        for idx in range(n):
+            assert (idx in bitset) == (idx in mapped) == (idx in reference)
+            assert bitset.next_unburned(idx) == mapped.next_unburned(idx) == reference.next_unburned(idx)
+
+
+def test_next_unburned_skips_long_runs_and_wraps():
+    n = 10_000
+    bitset = BurnedBitset(n, range(100, n))
+    assert bitset.next_unburned(100) == 0
+    assert bitset.next_unburned(5) == 5
+    bitset.add(5)
+    assert bitset.next_unburned(5) == 6
+    for idx in range(100):
+        bitset.add(idx)
+    assert len(bitset) == n
+    assert bitset.next_unburned(0) is None
+
+
+def test_trackers_give_identical_runs():
+    for seed in range(3):
+        random.seed(seed)
+        with_set = run_scenario(800, 4, 15, 3, backend="python", tracker="set")
+        random.seed(seed)
+        with_bitset = run_scenario(800, 4, 15, 3, backend="python", tracker="bitset")
+        assert with_set == with_bitset
+
+
+def test_mapped_bitset_spans_pools_larger_than_ram():
+    n = 10**11  # 12.5 GB of bits, sparse on disk; only touched pages are resident
+    mapped = MappedBitset(n, [0, n - 1])
+    assert len(mapped) == 2 and 0 in mapped and n - 1 in mapped
+    assert mapped.next_unburned(n - 1) == 1
+    for idx in range(MappedBitset.PAGE_PADS - 2, MappedBitset.PAGE_PADS + 2):
+        mapped.add(idx)
+    assert mapped.next_unburned(MappedBitset.PAGE_PADS - 2) == MappedBitset.PAGE_PADS + 2
+
+
+def test_mapped_bitset_reads_ahead_when_a_pointer_enters_a_page():
+    page = MappedBitset.PAGE_PADS
+    mapped = MappedBitset(8 * page)
+    mapped.touch(1, page - 1)
+    mapped.touch(1, page - 1)
+    assert mapped.hints == 1
+    # A Drift onto a burned pad of the next page burns nothing but still hints
+    mapped.add(page)
+    mapped.touch(1, page)
+    assert mapped.hints == 2
+    # So does a skip-drift landing several pages ahead, and a second pointer
+    mapped.touch(1, 5 * page + 3)
+    mapped.touch(2, page + 7)
+    assert mapped.hints == 4
+
+
+def test_mapped_runs_hint_at_every_page_a_pointer_enters(monkeypatch):
+    trackers = []
+    make_burned = burned_pads.make_burned
+
+    def capture(*args):
+        trackers.append(make_burned(*args))
+        return trackers[-1]
+
+    monkeypatch.setattr(burned_pads, "make_burned", capture)
+    n = 4 * MappedBitset.PAGE_PADS
+    run_scenario(n, 2, 15, 1, backend="python", seed=5, tracker="mmap", drift="skip",
+                 with_stats=True)
+    # Both pointers sweep nearly the whole ring, the silent one without burning
+    assert trackers[0].hints >= 2 * (n // MappedBitset.PAGE_PADS) - 2
+
+
+def test_mapped_tracker_gives_identical_runs(backend):
+    for seed in range(3):
+        in_ram = run_scenario(70_000, 4, 15, 3, backend=backend, seed=seed, movers="incremental")
+        mapped = run_scenario(70_000, 4, 15, 3, backend=backend, seed=seed, movers="incremental",
+                              tracker="mmap")
+        assert mapped == in_ram
+
+
+def test_intervals_match_set_and_coalesce():
+    rng = random.Random(5)
+    for n in [1, 2, 65, 300, 1000]:
+        reference, runs = BurnedSet(n), BurnedIntervals(n)
+        for _ in range(rng.randint(0, n)):
+            # Mostly extend the run after an existing pad, like a moving party
+            idx = (rng.choice(sorted(reference)) + 1) % n if reference and rng.random() < 0.7 \
+                else rng.randrange(n)
+            reference.add(idx)
+            runs.add(idx)
+        assert len(runs) == len(reference)
+        for idx in range(n):
+            assert (idx in runs) == (idx in reference)
+            assert runs.next_unburned(idx) == reference.next_unburned(idx)
+        spans = runs.runs()
+        assert all(end < start for (_, end), (start, _) in zip(spans, spans[1:]))
+
+
+def test_intervals_memory_follows_runs_not_n():
+    runs = BurnedIntervals(10**12, [0, 10**12 - 1])
+    for idx in range(1, 1000):
+        runs.add(idx)
+    assert runs.runs() == [(0, 1000), (10**12 - 1, 10**12)]
+    assert runs.next_unburned(10**12 - 1) == 1000
+
+
+def test_interval_tracker_gives_identical_runs(backend):
+    for seed in range(3):
+        for options in [{}, {"drift": "skip", "movers": "incremental"}]:
+            bitset = run_scenario(5000, 4, 15, 3, backend=backend, seed=seed, **options)
+            runs = run_scenario(5000, 4, 15, 3, backend=backend, seed=seed, tracker="intervals",
+                                **options)
+            assert runs == bitset
@@ -0,0 +1,79 @@
+import os
+import subprocess
+import sys
+import time
+
+import pytest
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.append(ROOT)
+from src import ring_native
+from src.ring_sim import run_scenario
+from src.rng import Pcg32
+from src.telemetry import TelemetryBuffer, iter_events
+
+N, M, D, X = 400000, 8, 30, 5
+_RUNNER = (
+    "import sys; sys.path.insert(0, sys.argv[1])\n"
+    "from src.ring_sim import run_scenario\n"
+    "from src.rng import Pcg32\n"
+    f"run_scenario({N}, {M}, {D}, {X}, backend='native', rng=Pcg32(5), checkpoint=sys.argv[2],\n"
+    "             checkpoint_every=5000, **eval(sys.argv[3]))\n"
+)
+
+
+def _preempt(path, options):
+    """Starts a checkpointed run in a child process and kills it after its first snapshot."""
+    child = subprocess.Popen([sys.executable, "-c", _RUNNER, ROOT, str(path), repr(options)])
+    deadline = time.monotonic() + 60
+    while not os.path.exists(path) and child.poll() is None and time.monotonic() < deadline:
+        time.sleep(0.001)
+    child.kill()
+    child.wait()
+    assert os.path.exists(path), "run finished before its first snapshot"
+
+
+@pytest.mark.needs_native
+@pytest.mark.parametrize("options", [
+    {},
+    {"coalesce": True, "movers": "incremental"},
+    {"schedule": "batch", "drift": "skip"},
+    {"event_driven": True, "propagation": "neighbor"},
+])
+def test_resumed_run_matches_uninterrupted_run(tmp_path, options):
+    path = tmp_path / "run.ckpt"
+    full_rng = Pcg32(5)
+    full = run_scenario(N, M, D, X, backend="native", rng=full_rng, with_stats=True, **options)
+
+    _preempt(path, options)
+    info = ring_native.checkpoint_info(path)
+    assert (info["n"], info["m"], info["d"], info["x"]) == (N, M, D, X)
+    assert info["iterations"] > 0 and info["iterations"] % 5000 == 0
+    assert info["bitset_offset"] % 4096 == 0
+
+    chunks = []
+    resumed_rng = Pcg32(5)
+    resumed = run_scenario(N, M, D, X, backend="native", rng=resumed_rng, checkpoint=path,
+                           checkpoint_every=5000, telemetry=TelemetryBuffer(chunks.append),
+                           with_stats=True, **options)
+    assert resumed == full
+    assert resumed_rng.getstate() == full_rng.getstate()
+    assert next(iter_events(b"".join(chunks)))[0] > 1
+    assert not os.path.exists(path)
+
+
+@pytest.mark.needs_native
+def test_snapshot_must_match_the_configuration(tmp_path):
+    path = tmp_path / "run.ckpt"
+    _preempt(path, {})
+    with pytest.raises(ring_native.CheckpointError):
+        run_scenario(N, M, D + 1, X, backend="native", seed=5, checkpoint=path)
+    with open(path, "r+b") as stream:
+        stream.truncate(5000)
+    with pytest.raises(ring_native.CheckpointError):
+        run_scenario(N, M, D, X, backend="native", seed=5, checkpoint=path)
+
+
+def test_python_backend_rejects_checkpoints(tmp_path):
+    with pytest.raises(ValueError):
+        run_scenario(400, 4, 15, 3, backend="python", seed=1, checkpoint=tmp_path / "run.ckpt")
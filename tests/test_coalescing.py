@@ -0,0 +1,57 @@
+import os
+import random
+import sys
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.ring_sim import AsynchronousNetwork, RingParty, run_scenario
+
+
+def _scripted_delays(monkeypatch, delays):
+    it = iter(delays)
+    monkeypatch.setattr(random, "randint", lambda a, b: next(it))
+
+
+def test_latest_position_wins(monkeypatch):
+    _scripted_delays(monkeypatch, [5, 0, 5])
+    parties = {1: RingParty(1, n=100, m=2, d=5), 2: RingParty(2, n=100, m=2, d=5)}
+
+    plain = AsynchronousNetwork(d_delay=5)
+    plain.send_broadcast(1, 10)  # due at t=5
+    plain.send_broadcast(1, 11)  # due at t=1
+    plain.tick(parties)
+    assert parties[2].view_of_others[1] == 11
+    for _ in range(4):
+        plain.tick(parties)
+    # Without coalescing the delayed older position overwrites the newer one
+    assert parties[2].view_of_others[1] == 10
+
+    _scripted_delays(monkeypatch, [5, 0])
+    parties = {1: RingParty(1, n=100, m=2, d=5), 2: RingParty(2, n=100, m=2, d=5)}
+    net = AsynchronousNetwork(d_delay=5, coalesce=True)
+    net.send_broadcast(1, 10)
+    net.send_broadcast(1, 11)
+    assert net.pending == 1 and net.superseded == 1
+    for _ in range(5):
+        net.tick(parties)
+        assert parties[2].view_of_others[1] == 11
+    assert net.pending == 0
+
+
+def test_one_update_per_sender_per_tick(monkeypatch):
+    _scripted_delays(monkeypatch, [2, 1, 1])
+    net = AsynchronousNetwork(d_delay=3, coalesce=True)
+    net.send_broadcast(1, 20)
+    net.current_time += 1
+    net.send_broadcast(1, 21)  # due at t=2 together with index 20
+    net.send_broadcast(2, 30)
+    assert [msg[1:] for msg in net.queue] == [(1, 21), (2, 30)]
+
+
+def test_coalescing_keeps_waste(backend):
+    for seed in range(5):
+        for n, m, d, x in [(600, 4, 15, 4), (600, 3, 15, 1), (2000, 4, 15, 2)]:
+            random.seed(seed)
+            plain = run_scenario(n, m, d, x, backend=backend)
+            random.seed(seed)
+            coalesced = run_scenario(n, m, d, x, backend=backend, coalesce=True)
+            assert plain == coalesced == m * d
@@ -0,0 +1,124 @@
+import os
+import random
+import sys
+from collections import Counter
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src import ring_native
+from src.delays import (GeometricDelay, LinkDelay, ParetoDelay, TableDelay, TraceDelay,
+                        UniformDelay, write_trace)
+from src.ring_sim import AsynchronousNetwork, RingParty, run_batch, run_scenario
+from src.rng import Pcg32
+
+
+def _trace(tmp_path, delays):
+    return write_trace(os.path.join(str(tmp_path), "delays.trace"), delays)
+
+
+def test_tables_draw_their_distribution():
+    model = TableDelay.from_weights([1, 1, 2])
+    assert model.cdf == [2**30, 2**31] and model.max_delay == 2
+    rng = Pcg32(5)
+    counts = Counter(model.draw(rng, 1) for _ in range(40_000))
+    assert abs(counts[2] / 40_000 - 0.5) < 0.01 and abs(counts[0] / 40_000 - 0.25) < 0.01
+
+    geometric = GeometricDelay(0.5, 10)
+    rng = Pcg32(6)
+    draws = [geometric.draw(rng, 1) for _ in range(40_000)]
+    assert abs(draws.count(0) / 40_000 - 0.5) < 0.01 and max(draws) == 10
+
+
+def test_pareto_tail_piles_up_at_the_bound():
+    model = ParetoDelay(1.0, 20)
+    rng = Pcg32(7)
+    draws = Counter(model.draw(rng, 1) for _ in range(40_000))
+    # P(delay >= 20) = 1 / 21 for alpha = 1, scale = 1
+    assert abs(draws[20] / 40_000 - 1 / 21) < 0.005
+    assert draws[0] > draws[1] > draws[5]
+
+
+def test_link_matrix_draws_on_the_link_to_the_predecessor():
+    def fixed(k):
+        return TableDelay.from_weights([0] * k + [1])
+    # links[s - 1][r - 1]: sender s, receiver r; the predecessor of 1 is 3
+    links = [[fixed(9)] * 3 for _ in range(3)]
+    links[0][2], links[1][0], links[2][1] = fixed(4), fixed(1), UniformDelay(0)
+    model = LinkDelay(links)
+    assert model.max_delay == 4
+    rng = Pcg32(1)
+    assert [model.draw(rng, s) for s in (1, 2, 3)] == [4, 1, 0]
+
+
+def test_trace_streams_in_chunks_and_starts_over(tmp_path):
+    model = TraceDelay(_trace(tmp_path, [3, 1, 4, 1, 5]), chunk=2)
+    assert model.count == 5 and model.max_delay == 5
+    model.reset()
+    draws = [model.draw(None, 1) for _ in range(7)]
+    assert draws == [3, 1, 4, 1, 5, 3, 1]
+    assert len(model._buf) <= 2
+    model.reset()
+    assert model.draw(None, 1) == 3
+    model.close()
+
+
+def test_network_delivers_on_trace_delays(tmp_path):
+    net = AsynchronousNetwork(0, delay_model=TraceDelay(_trace(tmp_path, [2, 0, 5])))
+    parties = {i: RingParty(i, n=100, m=2, d=5) for i in (1, 2)}
+    for index in (10, 11, 12):
+        net.send_broadcast(1, index)
+    assert net.d_delay == 5 and [msg[0] for msg in net.queue] == [0, 2, 5]
+    seen = []
+    for _ in range(5):
+        net.tick(parties)
+        seen.append(parties[2].view_of_others[1])
+    assert seen == [11, 10, 10, 10, 12]
+    net.delay_model.close()
+
+
+def _models(tmp_path):
+    trace = _trace(tmp_path, [random.Random(2).choice([1, 2, 2, 3, 30]) for _ in range(5000)])
+    return [
+        GeometricDelay(0.4, 15),
+        ParetoDelay(1.5, 40, scale=2.0),
+        LinkDelay([[GeometricDelay(0.2 + 0.1 * s, 5 + s + r) for r in range(4)]
+                   for s in range(4)]),
+        TraceDelay(trace),
+    ]
+
+
+@pytest.mark.parametrize("options", [
+    {},
+    {"coalesce": True, "drift": "skip", "adaptive": True},
+    {"propagation": "neighbor", "schedule": "batch", "movers": "incremental"},
+])
+@pytest.mark.needs_native
+def test_backends_draw_the_same_delays(tmp_path, options):
+    for model in _models(tmp_path):
+        runs = [run_scenario(3000, 4, 15, 3, backend=backend, rng=Pcg32(4), delay_model=model,
+                             with_stats=True, **options)
+                for backend in ("python", "native")]
+        assert runs[0] == runs[1], type(model).__name__
+    # Every scenario of a batch replays the trace from its start
+    batch = run_batch(3000, 4, 15, 2, [Pcg32(1), Pcg32(2)], backend="native",
+                      delay_model=model, fast_path=False)
+    assert batch == run_batch(3000, 4, 15, 2, [Pcg32(1), Pcg32(2)], backend="python",
+                              delay_model=model, fast_path=False)
+    model.close()
+
+
+def test_invalid_models_are_rejected(tmp_path):
+    bogus = os.path.join(str(tmp_path), "bogus.trace")
+    with open(bogus, "wb") as stream:
+        stream.write(b"not a trace at all, really")
+    with pytest.raises(ValueError):
+        TraceDelay(bogus)
+    with pytest.raises(ValueError):
+        run_scenario(100, 2, 5, 1, link_delay=3, delay_model=UniformDelay(3))
+    with pytest.raises(ValueError):
+        TableDelay([5, 3])
+    if ring_native.available():
+        with pytest.raises(ValueError):
+            run_scenario(100, 2, 5, 1, backend="native", delay_model=GeometricDelay(0.5, 5),
+                         checkpoint=str(tmp_path / "run.ckpt"))
@@ -0,0 +1,90 @@
+import os
+import random
+import sys
+import tempfile
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.burned_pads import BurnedBitset
+from src.encryption import EncryptionStage, PadFile
+from src.ring_sim import AsynchronousNetwork, PartyState
+
+N, PAD = 64, 32
+
+
+def _pad_file(tmp_path):
+    path = os.path.join(str(tmp_path), "pads.bin")
+    with open(path, "wb") as stream:
+        stream.write(random.Random(1).randbytes(N * PAD))
+    return path
+
+
+def test_batch_uses_one_run_and_one_broadcast(tmp_path, backend):
+    pads = PadFile(_pad_file(tmp_path), N, PAD, backend=backend)
+    state = PartyState(N, 2, 3)
+    party = state.parties()[1]
+    burned = BurnedBitset(N, [party.my_index])
+    network = AsynchronousNetwork(3, rng=random.Random(0))
+    stage = EncryptionStage(pads, burned, network, 3)
+    messages = [bytes([k]) * (k + 1) for k in range(5)]
+    for message in messages:
+        stage.submit(party, message)
+
+    sealed = stage.flush(party)
+    assert [idx for idx, _ in sealed] == [1, 2, 3, 4, 5]
+    assert network.sent == 1 and party.my_index == 5 and party.pads_used == 5
+    assert all(idx in burned for idx in range(6))
+    for (idx, ciphertext), message in zip(sealed, messages):
+        assert ciphertext != message
+        assert pads.decrypt(idx, ciphertext) == message
+    pads.close()
+
+
+def test_run_stops_at_burned_pads_and_the_safety_gap(tmp_path):
+    pads = PadFile(_pad_file(tmp_path), N, PAD)
+    state = PartyState(N, 2, 3)
+    party = state.parties()[1]
+    network = AsynchronousNetwork(3, rng=random.Random(0))
+    # Front neighbour starts at 32: at most 32 - 3 = 29 steps are safe
+    stage = EncryptionStage(pads, BurnedBitset(N, [0]), network, 3)
+    assert stage.reserve(party, 100) == (1, 29)
+    stage.burned.add(7)
+    assert stage.reserve(party, 100) == (1, 6)
+    for _ in range(10):
+        stage.submit(party, b"x")
+    assert len(stage.flush(party)) == 6
+    assert stage.pending(party) == 4
+    # The next pad is burned: nothing more can go out until the party drifts
+    assert stage.flush(party) == []
+    pads.close()
+
+
+def test_kernels_agree_across_the_ring_end(tmp_path, backend):
+    path = _pad_file(tmp_path)
+    data = random.Random(2).randbytes(5 * PAD + 7)
+    pads = PadFile(path, N, PAD, backend=backend)
+    buf = bytearray(data)
+    pads.xor(buf, N - 2)  # wraps after two pads
+    pads.close()
+    with open(path, "rb") as stream:
+        raw = stream.read()
+    stream_pad = raw[(N - 2) * PAD:] + raw
+    assert bytes(buf) == bytes(a ^ b for a, b in zip(data, stream_pad))
+
+
+def test_oversized_message_is_rejected(tmp_path):
+    pads = PadFile(_pad_file(tmp_path), N, PAD)
+    party = PartyState(N, 2, 3).parties()[1]
+    stage = EncryptionStage(pads, BurnedBitset(N), AsynchronousNetwork(3), 3)
+    with pytest.raises(ValueError):
+        stage.submit(party, bytes(PAD + 1))
+    pads.close()
+
+
+def test_short_pad_file_is_rejected():
+    with tempfile.NamedTemporaryFile() as stream:
+        stream.write(bytes(PAD))
+        stream.flush()
+        with pytest.raises(ValueError):
+            PadFile(stream.name, N, PAD)
@@ -0,0 +1,31 @@
+import os
+import random
+import sys
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.ring_sim import AsynchronousNetwork, RingParty, run_scenario
+from src.rng import Pcg32
+
+
+def test_skip_idle_lands_before_next_delivery(monkeypatch):
+    monkeypatch.setattr(random, "randint", lambda a, b: b)
+    net = AsynchronousNetwork(d_delay=12)
+    parties = {1: RingParty(1, n=100, m=2, d=5), 2: RingParty(2, n=100, m=2, d=5)}
+    net.send_broadcast(1, 40)
+
+    assert net.skip_idle() == 11
+    assert net.current_time == 11
+    assert parties[2].view_of_others[1] == 0
+    assert net.tick(parties) is True
+    assert parties[2].view_of_others[1] == 40
+    # Nothing pending: the clock stays put
+    assert net.skip_idle() == 0
+
+
+def test_event_driven_runs_are_identical(backend):
+    for n, m, d, x in [(2000, 4, 100, 4), (450, 4, 100, 3), (1000, 8, 60, 7), (600, 3, 0, 3)]:
+        stepped_rng, event_rng = Pcg32(2), Pcg32(2)
+        stepped = run_scenario(n, m, d, x, backend=backend, rng=stepped_rng)
+        event = run_scenario(n, m, d, x, backend=backend, rng=event_rng, event_driven=True)
+        assert stepped == event
+        assert stepped_rng.getstate() == event_rng.getstate()
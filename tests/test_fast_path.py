@@ -0,0 +1,68 @@
+import os
+import random
+import sys
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.rng import Pcg32
+from src.ring_sim import closed_form_waste, run_batch, run_scenario
+
+OPTIONS = [
+    {},
+    {"coalesce": True, "drift": "skip"},
+    {"movers": "incremental", "event_driven": True},
+    {"propagation": "neighbor", "schedule": "batch"},
+]
+
+
+def test_closed_form_matches_simulator_on_random_seeds(backend):
+    rng = random.Random(11)
+    for _ in range(60):
+        m = rng.randint(1, 6)
+        n = rng.randint(1, 300)
+        d = rng.randint(1, 20)
+        x = rng.randint(0, 1)
+        expected = closed_form_waste(n, m, d, x)
+        assert expected is not None
+        seed = rng.randrange(2**32)
+        simulated = run_scenario(n, m, d, x, backend=backend, seed=seed, fast_path=False,
+                                 **rng.choice(OPTIONS))
+        assert simulated == expected, (n, m, d, x, backend, seed)
+
+
+def test_closed_form_declines_schedule_dependent_configurations():
+    assert closed_form_waste(2000, 4, 0, 1) is None
+    assert closed_form_waste(2000, 4, 15, 2) is None
+    assert closed_form_waste(2000, 4, 15, 5) is None
+    # With d=0 parties can land on the same index and stop early
+    wastes = {run_scenario(10, 4, 0, 1, seed=seed, fast_path=False) for seed in range(12)}
+    assert len(wastes) > 1
+
+
+def test_fast_path_applies_automatically_without_drawing(backend):
+    rng = Pcg32(7)
+    before = rng.getstate()
+    assert run_scenario(2000, 4, 15, 1, backend=backend, rng=rng) == 60
+    assert rng.getstate() == before
+    assert run_scenario(10**6, 4, 15, 0, backend=backend, rng=rng) == 10**6
+    assert run_batch(2000, 4, 15, 1, [Pcg32(1), Pcg32(2)], backend=backend) == [60, 60]
+
+
+def test_runs_without_senders_end_at_once(backend):
+    # No party can ever burn a pad, so the silent ones must not yield forever
+    options = [{}, {"schedule": "batch"}, {"movers": "incremental", "event_driven": True},
+               {"schedule": "sharded", "shards": 2}]
+    for m in (2, 4, 5):
+        for extra in options:
+            waste, stats = run_scenario(10**5, m, 15, 0, backend=backend, seed=m, with_stats=True,
+                                        fast_path=False, **extra)
+            assert waste == 10**5 and stats.iterations == 0
+            # fast_path=True puts m in {2, 4} on the native fixed-m kernels
+            assert run_scenario(10**5, m, 15, 0, backend=backend, seed=m, with_stats=True,
+                                **extra)[0] == 10**5
+
+
+def test_stats_still_simulate():
+    rng = Pcg32(3)
+    waste, stats = run_scenario(2000, 4, 15, 1, rng=rng, with_stats=True)
+    assert waste == 60 and stats.data_moves == 2000 - 60 - 1 and stats.ticks > 0
+    assert rng.getstate() != Pcg32(3).getstate()
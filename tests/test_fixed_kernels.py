@@ -0,0 +1,58 @@
+import os
+import random
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src import ring_native
+from src.ring_sim import run_batch, run_scenario
+from src.rng import Pcg32
+
+OPTIONS = [
+    {},
+    {"drift": "skip"},
+    {"event_driven": True, "propagation": "neighbor"},
+    {"link_delay": 3, "drift": "skip", "event_driven": True},
+    {"link_delay": 40},
+]
+
+
+@pytest.mark.needs_native
+def test_kernels_cover_small_rings_on_the_single_schedule():
+    for m in (2, 3, 4, 8):
+        assert ring_native.fixed_kernel(2000, m, 15, 1) == m
+        assert ring_native.fixed_kernel(2000, m, 15, 1, skip_drift=True, event_driven=True,
+                                        neighbor_only=True, link_delay=4) == m
+    assert ring_native.fixed_kernel(2000, 5, 15, 1) == 0
+    for flag in ("coalesce", "incremental", "batch", "intervals", "adaptive"):
+        assert ring_native.fixed_kernel(2000, 4, 15, 1, **{flag: True}) == 0
+    assert ring_native.fixed_kernel(2000, 4, 15, 1, delay_cdf=[[0, 2**63]]) == 0
+
+
+@pytest.mark.needs_native
+def test_kernels_match_the_generic_engine():
+    rng = random.Random(29)
+    for _ in range(200):
+        m = rng.choice((2, 3, 4, 8))
+        n, d, x = rng.randint(1, 3000), rng.randint(0, 20), rng.randint(1, m)
+        options, seed = rng.choice(OPTIONS), rng.randrange(2**32)
+        results = []
+        for backend, fast_path in (("python", True), ("native", False), ("native", True)):
+            gen = Pcg32(seed)
+            result = run_scenario(n, m, d, x, backend=backend, rng=gen, with_stats=True,
+                                  fast_path=fast_path, **options)
+            results.append((result, gen.getstate()))
+        assert results[0] == results[1] == results[2], (n, m, d, x, options)
+
+
+@pytest.mark.needs_native
+def test_batches_match_the_generic_engine():
+    for m, x in ((3, 2), (4, 3), (8, 8)):
+        outcomes = []
+        for fast_path in (False, True):
+            rngs = [Pcg32(seed) for seed in range(20)]
+            results = run_batch(2000, m, 15, x, rngs, backend="native", with_stats=True,
+                                fast_path=fast_path)
+            outcomes.append((results, [gen.getstate() for gen in rngs]))
+        assert outcomes[0] == outcomes[1]
@@ -0,0 +1,44 @@
+import os
+import random
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.ring_sim import LegalMovers, run_scenario
+from src.rng import Pcg32
+
+
+def test_legal_movers_swap_remove():
+    movers = LegalMovers()
+    for pid in (1, 2, 3, 4):
+        movers.update(pid, True)
+    movers.update(2, True)
+    assert movers.ids == [1, 2, 3, 4]
+    movers.update(2, False)
+    assert sorted(movers.ids) == [1, 3, 4]
+    assert movers.ids[1] == 4  # last id moved into the freed slot
+    movers.update(2, False)
+    movers.update(4, False)
+    movers.update(1, False)
+    assert movers.ids == [3]
+
+
+def test_incremental_movers_keep_waste():
+    for seed in range(3):
+        for n, m, d, x in [(800, 4, 15, 3), (800, 4, 15, 1), (1500, 16, 5, 9), (600, 4, 0, 4)]:
+            random.seed(seed)
+            scanned = run_scenario(n, m, d, x, backend="python", movers="scan")
+            random.seed(seed)
+            incremental = run_scenario(n, m, d, x, backend="python", movers="incremental")
+            assert scanned == incremental
+
+
+@pytest.mark.needs_native
+def test_incremental_movers_match_across_backends():
+    for n, m, d, x in [(1500, 16, 5, 9), (2000, 4, 15, 2), (1000, 64, 3, 64)]:
+        py_rng, native_rng = Pcg32(4), Pcg32(4)
+        py = run_scenario(n, m, d, x, backend="python", rng=py_rng, movers="incremental")
+        native = run_scenario(n, m, d, x, backend="native", rng=native_rng, movers="incremental")
+        assert py == native
+        assert py_rng.getstate() == native_rng.getstate()
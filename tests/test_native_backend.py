@@ -0,0 +1,65 @@
+import os
+import random
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.ring_sim import run_batch, run_scenario
+from src.rng import Pcg32
+
+
+@pytest.mark.needs_native
+def test_native_waste_matches_python_bounds():
+    for n, m, d, x in [(400, 3, 15, 1), (400, 4, 15, 4), (2000, 4, 15, 2), (2000, 4, 0, 4)]:
+        native = run_scenario(n, m, d, x, backend="native")
+        python = run_scenario(n, m, d, x, backend="python")
+        assert isinstance(native, int)
+        assert native == python == m * d
+
+
+@pytest.mark.needs_native
+def test_native_reproducible_with_global_seed():
+    random.seed(7)
+    w1 = run_scenario(600, 4, 15, 3, backend="native")
+    random.seed(7)
+    w2 = run_scenario(600, 4, 15, 3, backend="native")
+    assert w1 == w2
+
+
+@pytest.mark.needs_native
+def test_native_rejects_invalid_configuration():
+    with pytest.raises(ValueError):
+        run_scenario(400, 4, 15, 5, backend="native")
+
+
+def test_unknown_backend_rejected():
+    with pytest.raises(ValueError):
+        run_scenario(400, 4, 15, 1, backend="fortran")
+
+
+@pytest.mark.needs_native
+def test_native_stats_match_python():
+    for options in ({}, {"movers": "incremental", "event_driven": True}, {"coalesce": True}):
+        py = run_scenario(2000, 4, 15, 3, backend="python", seed=3, with_stats=True, **options)
+        native = run_scenario(2000, 4, 15, 3, backend="native", seed=3, with_stats=True, **options)
+        assert py == native
+        assert py[1].ticks > 0 and py[1].delivered <= py[1].broadcasts
+
+
+@pytest.mark.needs_native
+def test_untimed_runs_match_runs_with_stats():
+    for fast_path in (False, True):
+        for options in ({}, {"schedule": "batch"}, {"schedule": "sharded", "shards": 2}):
+            plain, timed = Pcg32(5), Pcg32(5)
+            waste = run_scenario(2000, 4, 15, 3, backend="native", rng=plain, fast_path=fast_path,
+                                 **options)
+            assert waste == run_scenario(2000, 4, 15, 3, backend="native", rng=timed,
+                                         fast_path=fast_path, with_stats=True, **options)[0]
+            assert plain.getstate() == timed.getstate()
+        rngs, timed = [Pcg32(seed) for seed in range(4)], [Pcg32(seed) for seed in range(4)]
+        wastes = run_batch(2000, 4, 15, 3, rngs, backend="native", fast_path=fast_path)
+        outcomes = run_batch(2000, 4, 15, 3, timed, backend="native", fast_path=fast_path,
+                             with_stats=True)
+        assert wastes == [waste for waste, _ in outcomes]
+        assert [gen.getstate() for gen in rngs] == [gen.getstate() for gen in timed]
@@ -38,3 +38,45 @@ def test_network_delivery_time_and_no_self_update(monkeypatch):
 
     # Sender should NOT “receive” its own update
     assert parties[1].view_of_others[1] == 0
+
+
+def _reference_tick(queue, current_time, parties):
+    """Linear-rescan delivery that the timing wheel replaced."""
+    delivered = [msg for msg in queue if msg[0] <= current_time]
+    remaining = [msg for msg in queue if msg[0] > current_time]
+    for _, sender_id, idx in delivered:
+        for p_id, party in parties.items():
+            if p_id != sender_id:
+                party.update_view(sender_id, idx)
+    return remaining, len(delivered) > 0
+
+
+def test_timing_wheel_matches_linear_rescan(monkeypatch):
+    rng = random.Random(99)
+    draws = []
+
+    def recording_randint(a, b):
+        draws.append(rng.randint(a, b))
+        return draws[-1]
+
+    monkeypatch.setattr(random, "randint", recording_randint)
+
+    d_delay, m = 7, 4
+    net = AsynchronousNetwork(d_delay=d_delay)
+    wheel_parties = {i: RingParty(i, n=1000, m=m, d=5) for i in range(1, m + 1)}
+    ref_parties = {i: RingParty(i, n=1000, m=m, d=5) for i in range(1, m + 1)}
+    ref_queue = []
+
+    for _ in range(500):
+        for _ in range(rng.randint(0, 3)):
+            sender, idx = rng.randint(1, m), rng.randint(0, 999)
+            net.send_broadcast(sender, idx)
+            ref_queue.append((net.current_time + draws[-1], sender, idx))
+
+        delivered = net.tick(wheel_parties)
+        ref_queue, ref_delivered = _reference_tick(ref_queue, net.current_time, ref_parties)
+
+        assert delivered == ref_delivered
+        assert net.pending == len(ref_queue)
+        for i in range(1, m + 1):
+            assert wheel_parties[i].view_of_others == ref_parties[i].view_of_others
@@ -0,0 +1,61 @@
+import os
+import sys
+import threading
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src import ring_native
+
+
+@pytest.mark.needs_native
+def test_reserve_respects_gap_and_burned_pads():
+    alloc = ring_native.PadAllocator(100, 5, 10, 30)
+    assert alloc.burn(12) and not alloc.burn(12)
+    taken = [alloc.reserve() for _ in range(20)]
+    # Each step needs a gap above d=5 to the front at 30, so the party can
+    # reach 25; 12 was burned and is stepped over
+    assert taken[:14] == [11] + list(range(13, 26))
+    assert taken[14:] == [None] * 6
+    assert alloc.position == 25 and alloc.used == 14
+    alloc.set_front(40)
+    assert alloc.reserve() == 26
+    alloc.close()
+
+
+@pytest.mark.needs_native
+def test_native_threads_never_share_a_pad():
+    n, d = 1 << 20, 15
+    alloc = ring_native.PadAllocator(n, d, 0, n // 2)
+    for idx in range(1000, 200_000, 7):
+        alloc.burn(idx)
+    taken = alloc.contend(threads=8, attempts=100_000)
+    assert len(taken) == len(set(taken)) == alloc.used
+    expected = set(range(1, n // 2 - d + 1)) - set(range(1000, 200_000, 7))
+    assert set(taken) == expected
+
+
+@pytest.mark.needs_native
+def test_python_threads_contend_across_the_ring_end():
+    n = 10_000
+    alloc = ring_native.PadAllocator(n, 3, n - 500, 4000)
+    results = [[] for _ in range(4)]
+
+    def sender(out):
+        while (idx := alloc.reserve()) is not None:
+            out.append(idx)
+
+    threads = [threading.Thread(target=sender, args=(out,)) for out in results]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    taken = [idx for out in results for idx in out]
+    assert len(taken) == len(set(taken))
+    assert set(taken) == set(range(n - 499, n)) | set(range(0, 4000 - 3 + 1))
+
+
+@pytest.mark.needs_native
+def test_invalid_configuration_is_rejected():
+    with pytest.raises(ValueError):
+        ring_native.PadAllocator(100, 5, 100, 0)
@@ -0,0 +1,41 @@
+import os
+import sys
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.ring_sim import AsynchronousNetwork, PartyState, RingParty
+
+
+def test_party_state_starts_evenly_spaced():
+    state = PartyState(1000, 4, 10)
+    assert list(state.my_index) == [0, 250, 500, 750]
+    assert all(state.view(r, s) == (s - 1) * 250 for r in range(1, 5) for s in range(1, 5))
+    assert state.views.typecode == "i"
+    assert PartyState(2**40, 4, 10).views.typecode == "q"
+
+
+def test_broadcast_update_skips_sender_row():
+    state = PartyState(1000, 4, 10)
+    state.broadcast_update(2, 777)
+    assert [state.view(r, 2) for r in range(1, 5)] == [777, 250, 777, 777]
+    assert state.view(1, 3) == 500
+
+
+def test_ring_party_is_a_view_over_the_state():
+    state = PartyState(1000, 3, 10)
+    parties = state.parties()
+    parties[2].my_index = 400
+    parties[2].pads_used += 1
+    parties[1].view_of_others[2] = 400
+    assert state.my_index[1] == 400 and state.pads_used[1] == 1
+    assert state.view(1, 2) == 400
+    assert dict(parties[1].view_of_others) == {1: 0, 2: 400, 3: 666}
+
+
+def test_tick_accepts_state_or_party_dict():
+    soa, objects = PartyState(1000, 3, 0), {i: RingParty(i, 1000, 3, 0) for i in (1, 2, 3)}
+    for parties in (soa, objects):
+        net = AsynchronousNetwork(0)
+        net.send_broadcast(1, 42)
+        net.tick(parties)
+    assert [soa.view(r, 1) for r in (1, 2, 3)] == [0, 42, 42]
+    assert [objects[r].view_of_others[1] for r in (1, 2, 3)] == [0, 42, 42]
@@ -0,0 +1,126 @@
+import io
+import os
+import re
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from bench import bench_ring_sim
+from src.profiling import METRICS, PHASES, Profile
+from src.ring_sim import run_scenario
+from src.rng import Pcg32
+
+
+def _profiled(every=1, **options):
+    profile = Profile(every=every)
+    result = run_scenario(2000, 4, 15, 3, backend="native", rng=Pcg32(7), with_stats=True,
+                          profile=profile, **options)
+    return result, profile
+
+
+@pytest.mark.needs_native
+def test_phases_count_every_iteration_and_move():
+    (_, stats), profile = _profiled()
+    phases = profile.phases
+    assert profile.runs == 1
+    assert phases["step"]["calls"] == phases["tick"]["calls"] == stats.iterations
+    assert phases["move"]["calls"] == stats.data_moves + stats.drift_moves + stats.yield_moves
+    assert phases["enqueue"]["calls"] == stats.broadcasts
+    assert phases["movers"]["calls"] >= stats.iterations - stats.blocked_ticks
+    assert all(phases[phase]["nanoseconds"] > 0 for phase in PHASES)
+    assert phases["step"]["nanoseconds"] >= phases["move"]["nanoseconds"] >= phases["enqueue"]["nanoseconds"]
+
+
+@pytest.mark.needs_native
+def test_sampling_times_one_iteration_in_every():
+    (_, stats), profile = _profiled(every=10)
+    assert profile.phases["step"]["calls"] == -(-stats.iterations // 10)
+    (_, stats), batched = _profiled(every=7, movers="incremental", schedule="batch")
+    assert batched.phases["step"]["calls"] == -(-stats.iterations // 7)
+
+
+@pytest.mark.needs_native
+def test_profiling_leaves_results_unchanged():
+    for options in ({}, {"movers": "incremental"}, {"schedule": "batch", "drift": "skip"}):
+        plain = run_scenario(2000, 4, 15, 3, backend="native", rng=Pcg32(3), with_stats=True,
+                             **options)
+        profiled = run_scenario(2000, 4, 15, 3, backend="native", rng=Pcg32(3), with_stats=True,
+                                profile=Profile(every=3), **options)
+        assert plain == profiled
+
+
+@pytest.mark.needs_native
+def test_profile_accumulates_over_runs():
+    profile = Profile()
+    for seed in range(3):
+        run_scenario(2000, 4, 15, 3, backend="native", rng=Pcg32(seed), profile=profile)
+    assert profile.runs == 3
+    assert profile.phases["step"]["calls"] > 0
+
+
+@pytest.mark.needs_native
+def test_hardware_counters_are_zero_when_unavailable():
+    _, profile = _profiled()
+    if profile.hardware_counters:
+        assert profile.phases["step"]["cycles"] > 0
+    else:
+        assert all(profile.phases[phase][metric] == 0 for phase in PHASES
+                   for metric in ("cycles", "cache_misses", "branch_misses"))
+    without = Profile(hardware=False)
+    run_scenario(2000, 4, 15, 3, backend="native", rng=Pcg32(7), profile=without)
+    assert not without.hardware_counters
+    assert without.phases["step"]["cycles"] == 0
+
+
+@pytest.mark.needs_native
+def test_collapsed_stacks_sum_to_the_step_total():
+    _, profile = _profiled()
+    lines = profile.collapsed()
+    assert lines and all(re.fullmatch(r"run_scenario(;\w+)+ \d+", line) for line in lines)
+    assert "run_scenario;step;move;enqueue" in {line.rsplit(" ", 1)[0] for line in lines}
+    total = sum(int(line.rsplit(" ", 1)[1]) for line in lines)
+    assert total >= profile.phases["step"]["nanoseconds"]
+    out = io.StringIO()
+    profile.write_collapsed(out, root="cell")
+    assert out.getvalue().startswith("cell;step")
+
+
+def test_profile_rejects_the_python_backend_and_sharded_runs():
+    with pytest.raises(ValueError):
+        run_scenario(2000, 4, 15, 3, backend="python", profile=Profile())
+    with pytest.raises(ValueError):
+        run_scenario(2000, 4, 15, 3, backend="native", schedule="sharded", shards=2,
+                     profile=Profile())
+    with pytest.raises(ValueError):
+        Profile(every=0)
+
+
+def test_exclusive_totals_subtract_child_phases():
+    profile = Profile()
+    totals = {phase: dict.fromkeys(("calls",) + METRICS, 0) for phase in PHASES}
+    for phase, ns in zip(PHASES, (100, 20, 10, 50, 30)):
+        totals[phase].update(calls=1, nanoseconds=ns)
+    profile.add(totals, hardware_counters=False)
+    assert profile.exclusive() == {"step": 20, "tick": 20, "movers": 10, "move": 20, "enqueue": 30}
+    assert sorted(profile.collapsed()) == [
+        "run_scenario;step 20",
+        "run_scenario;step;move 20",
+        "run_scenario;step;move;enqueue 30",
+        "run_scenario;step;movers 10",
+        "run_scenario;step;tick 20",
+    ]
+    assert profile.collapsed(metric="cycles") == []
+    with pytest.raises(ValueError):
+        profile.collapsed(metric="calls")
+
+
+@pytest.mark.needs_native
+def test_bench_cells_report_profiles():
+    record = bench_ring_sim.run_cell(2000, 4, 15, 3, backend="native", trials=2, seed=1,
+                                     options={}, profile_every=4)
+    assert record["profile"]["runs"] == 2
+    assert record["collapsed"]
+    plain = bench_ring_sim.run_cell(400, 4, 15, 3, backend="python", trials=1, seed=1,
+                                    options={}, profile_every=4)
+    assert "profile" not in plain
@@ -0,0 +1,43 @@
+import os
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.ring_sim import AsynchronousNetwork, PartyState, RingParty, run_scenario
+from src.rng import Pcg32
+
+
+def test_neighbor_mode_updates_only_the_predecessor():
+    parties = {i: RingParty(i, n=1000, m=4, d=10) for i in range(1, 5)}
+    net = AsynchronousNetwork(0, propagation="neighbor")
+    net.send_broadcast(3, 600)
+    net.send_broadcast(1, 100)
+    net.tick(parties)
+    assert [parties[r].view_of_others[3] for r in range(1, 5)] == [500, 600, 500, 500]
+    assert [parties[r].view_of_others[1] for r in range(1, 5)] == [0, 0, 0, 100]
+    assert net.view_updates == 2
+
+    state = PartyState(1000, 4, 10)
+    net = AsynchronousNetwork(0)
+    net.send_broadcast(3, 600)
+    net.tick(state)
+    assert [state.view(r, 3) for r in range(1, 5)] == [600, 600, 500, 600]
+    assert net.view_updates == 3
+
+
+def test_unknown_propagation_is_rejected():
+    with pytest.raises(ValueError):
+        AsynchronousNetwork(5, propagation="gossip")
+
+
+def test_neighbor_mode_runs_are_identical(backend):
+    for n, m, d, x in [(2000, 4, 15, 4), (1000, 8, 30, 5), (600, 3, 0, 2), (300, 1, 5, 1)]:
+        full_rng, neighbor_rng = Pcg32(4), Pcg32(4)
+        full, full_stats = run_scenario(n, m, d, x, backend=backend, rng=full_rng, with_stats=True)
+        neighbor, neighbor_stats = run_scenario(n, m, d, x, backend=backend, rng=neighbor_rng,
+                                                propagation="neighbor", with_stats=True)
+        assert full == neighbor
+        assert full_rng.getstate() == neighbor_rng.getstate()
+        assert full_stats.view_updates == (m - 1) * full_stats.delivered
+        assert neighbor_stats.view_updates == (full_stats.delivered if m > 1 else 0)
@@ -0,0 +1,57 @@
+import os
+import random
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.ring_sim import AsynchronousNetwork, run_scenario
+from src.rng import Pcg32
+
+
+def test_pcg32_reference_vector():
+    # pcg32-demo from the reference implementation: seed 42, sequence 54
+    rng = Pcg32(42, stream=54)
+    assert [rng.next32() for _ in range(3)] == [0xA15C02B7, 0x7B47F409, 0xBA1D3330]
+
+
+def test_streams_are_reproducible_and_independent():
+    a, b = Pcg32(7, stream=1), Pcg32(7, stream=2)
+    xs = [a.randint(0, 1000) for _ in range(50)]
+    again = Pcg32(7, stream=1)
+    assert xs == [again.randint(0, 1000) for _ in range(50)]
+    assert xs != [b.randint(0, 1000) for _ in range(50)]
+    assert sorted(Pcg32(3).sample(range(10), 10)) == list(range(10))
+
+
+def test_seeded_scenario_leaves_global_random_alone():
+    random.seed(1)
+    expected = random.random()
+    random.seed(1)
+    w1 = run_scenario(600, 4, 15, 3, backend="python", seed=99)
+    assert random.random() == expected
+    w2 = run_scenario(600, 4, 15, 3, backend="python", rng=Pcg32(99))
+    assert w1 == w2
+
+
+def test_network_draws_from_its_rng():
+    reference = Pcg32(5)
+    expected = [reference.randint(0, 9) for _ in range(20)]
+    net = AsynchronousNetwork(d_delay=9, rng=Pcg32(5))
+    for _ in range(20):
+        net.send_broadcast(1, 0)
+    assert sorted(msg[0] for msg in net.queue) == sorted(expected)
+
+
+@pytest.mark.needs_native
+def test_backends_consume_identical_streams():
+    cases = [(600, 4, 15, 3, {}), (2000, 4, 15, 1, {}), (1000, 4, 0, 4, {}),
+             (2000, 4, 15, 2, {"coalesce": True}), (2000, 3, 15, 2, {"drift": "skip"})]
+    for seed in range(3):
+        for n, m, d, x, options in cases:
+            py_rng, native_rng = Pcg32(seed, stream=8), Pcg32(seed, stream=8)
+            py = run_scenario(n, m, d, x, backend="python", rng=py_rng, **options)
+            native = run_scenario(n, m, d, x, backend="native", rng=native_rng, **options)
+            assert py == native
+            # Same final generator state means the same sequence of choices
+            assert py_rng.getstate() == native_rng.getstate()
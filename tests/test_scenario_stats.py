@@ -0,0 +1,28 @@
+import os
+import sys
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.ring_sim import AsynchronousNetwork, run_scenario
+
+
+def test_network_tracks_max_queue_depth():
+    net = AsynchronousNetwork(0)
+    for sender in (1, 2, 3):
+        net.send_broadcast(sender, 10)
+    net.tick({})
+    net.send_broadcast(1, 11)
+    assert net.max_pending == 3 and net.pending == 1
+
+
+def test_counters_are_consistent(backend):
+    for n, m, d, x, options in [(2000, 4, 15, 3, {}), (1500, 4, 20, 2, {"schedule": "batch"}),
+                                (600, 3, 0, 3, {"movers": "incremental"})]:
+        waste, stats = run_scenario(n, m, d, x, backend=backend, seed=12, with_stats=True, **options)
+        assert stats.data_moves + stats.drift_moves + stats.yield_moves == stats.broadcasts
+        assert stats.data_moves == n - waste - x
+        assert stats.blocked_ticks <= stats.iterations
+        assert 0 < stats.max_queue_depth <= stats.broadcasts
+        assert stats.status_evaluations >= stats.broadcasts
+        assert stats.network_s > 0 and stats.moves_s > 0
+        if x == m:
+            assert stats.yield_moves == 0
@@ -0,0 +1,95 @@
+import os
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.delays import GeometricDelay, TableDelay
+from src.ring_sim import AsynchronousNetwork, PartyState, run_scenario
+from src.rng import Pcg32
+
+CASES = [(1500, 6, 10, 3), (2000, 12, 5, 7), (800, 5, 3, 5)]
+# No delay below 3 ticks, so native shards sync every third tick
+SLOW_LINKS = TableDelay.from_weights([0, 0, 0, 1, 2, 3])
+
+
+def _shard_counts(m):
+    return sorted({1, 2, m // 2, m})
+
+
+class _ScriptedDelay:
+    def __init__(self, delays):
+        self.delays, self.max_delay = delays, max(delays)
+
+    def reset(self):
+        self._next = iter(self.delays)
+
+    def draw(self, rng, sender_id):
+        return next(self._next)
+
+
+def test_stale_updates_never_move_a_view_back():
+    parties = PartyState(100, 2, 1)
+    network = AsynchronousNetwork(0, propagation="neighbor", drop_stale=True,
+                                  delay_model=_ScriptedDelay([3, 1]))
+    network.send_broadcast(2, 40)
+    network.tick(parties)
+    network.send_broadcast(2, 45)
+    network.tick(parties)
+    assert parties.view(1, 2) == 45
+    # The older update arrives last and is dropped
+    network.tick(parties)
+    assert parties.view(1, 2) == 45
+    assert network.delivered == 2 and network.view_updates == 1
+
+
+def test_shards_keep_waste_bounded(backend):
+    for n, m, d, x in CASES:
+        for shards in _shard_counts(m):
+            waste, stats = run_scenario(n, m, d, x, backend=backend, seed=2, schedule="sharded",
+                                        shards=shards, with_stats=True)
+            assert 0 <= waste <= m * d
+            assert stats.data_moves == n - waste - x
+            assert stats.broadcasts == stats.data_moves + stats.drift_moves + stats.yield_moves
+
+
+@pytest.mark.parametrize("options", [
+    {},
+    {"drift": "skip", "event_driven": True},
+    {"delay_model": SLOW_LINKS, "event_driven": True},
+    {"delay_model": GeometricDelay(0.3, 12), "tracker": "intervals"},
+])
+@pytest.mark.needs_native
+def test_backends_agree_for_any_shard_count(options):
+    for n, m, d, x in CASES:
+        for shards in _shard_counts(m):
+            results = []
+            for backend in ("python", "native"):
+                rng = Pcg32(7)
+                result = run_scenario(n, m, d, x, backend=backend, rng=rng, schedule="sharded",
+                                      shards=shards, with_stats=True, **options)
+                results.append((result, rng.getstate()))
+            assert results[0] == results[1]
+
+
+@pytest.mark.needs_native
+def test_native_runs_do_not_depend_on_thread_timing():
+    for options in ({"drift": "skip"}, {"delay_model": SLOW_LINKS}):
+        runs = [run_scenario(20_000, 64, 5, 40, backend="native", seed=4, schedule="sharded",
+                             shards=8, with_stats=True, **options) for _ in range(5)]
+        assert all(run == runs[0] for run in runs)
+
+
+def test_unsupported_options_are_rejected():
+    bad = [
+        {"shards": 0}, {"shards": 5}, {"shards": None}, {"coalesce": True},
+        {"movers": "incremental"}, {"adaptive": True},
+    ]
+    for options in bad:
+        with pytest.raises(ValueError):
+            run_scenario(1000, 4, 5, 2, backend="python", schedule="sharded",
+                         **{"shards": 2, **options})
+    with pytest.raises(ValueError):
+        run_scenario(1000, 4, 0, 2, schedule="sharded", shards=2)
+    with pytest.raises(ValueError):
+        run_scenario(1000, 4, 5, 2, shards=2)
@@ -0,0 +1,44 @@
+import os
+import random
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src import ring_sim
+from src.ring_sim import run_scenario
+
+CASES = [(2000, 4, 15, 2), (2000, 4, 15, 3), (2000, 3, 15, 2), (3000, 6, 10, 4), (1000, 4, 0, 3)]
+
+
+def test_skip_drift_reports_same_waste(backend):
+    for seed in range(3):
+        for n, m, d, x in CASES:
+            random.seed(seed)
+            stepped = run_scenario(n, m, d, x, backend=backend, drift="step")
+            random.seed(seed)
+            skipped = run_scenario(n, m, d, x, backend=backend, drift="skip")
+            assert stepped == skipped
+
+
+def test_skip_drift_broadcasts_once_per_burned_run(monkeypatch):
+    sent = []
+    original = ring_sim.AsynchronousNetwork.send_broadcast
+
+    def counting_send(self, sender_id, new_index):
+        sent.append(new_index)
+        original(self, sender_id, new_index)
+
+    monkeypatch.setattr(ring_sim.AsynchronousNetwork, "send_broadcast", counting_send)
+    counts = {}
+    for mode in ("step", "skip"):
+        sent.clear()
+        random.seed(11)
+        run_scenario(2000, 4, 15, 3, backend="python", drift=mode)
+        counts[mode] = len(sent)
+    assert counts["skip"] < counts["step"]
+
+
+def test_unknown_drift_mode_rejected():
+    with pytest.raises(ValueError):
+        run_scenario(400, 4, 15, 1, backend="python", drift="hover")
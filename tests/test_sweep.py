@@ -0,0 +1,95 @@
+import os
+import struct
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src import sweep as sweep_module
+from src.delays import GeometricDelay
+from src.sweep import CACHE_HEADER, CACHE_MAGIC, Cell, Sweep, grid, half_width
+from src.trials import run_trials
+
+# A cell whose waste varies from trial to trial
+NOISY = Cell(1000, 4, 15, 3, {"adaptive": True, "delay_model": GeometricDelay(0.3, 15)})
+
+
+def test_cells_are_computed_once(tmp_path):
+    first = Sweep(str(tmp_path), seed=4, workers=1, backend="python").run(NOISY, 6)
+    assert first.computed == 6
+    assert first.waste == run_trials(*NOISY[:4], 6, seed=4, workers=1, backend="python",
+                                     **NOISY.options)
+    again = Sweep(str(tmp_path), seed=4, workers=1, backend="python")
+    assert again.run(NOISY, 6) == first._replace(computed=0)
+    # Only the new trials are simulated
+    longer = again.run(NOISY, 9)
+    assert longer.computed == 3 and longer.waste[:6] == first.waste
+    assert longer.waste == run_trials(*NOISY[:4], 9, seed=4, workers=1, backend="python",
+                                      **NOISY.options)
+
+
+def test_key_covers_parameters_seed_and_version(tmp_path):
+    sweep = Sweep(str(tmp_path), seed=1, workers=1)
+    sweep.run((400, 4, 15, 2), 3)
+    assert sweep.run((400, 4, 15, 2, {}), 3).computed == 0
+    assert sweep.run((400, 4, 15, 2, {"drift": "skip"}), 3).computed == 3
+    assert sweep.run((400, 4, 10, 2), 3).computed == 3
+    assert Sweep(str(tmp_path), seed=2, workers=1).run((400, 4, 15, 2), 3).computed == 3
+    assert Sweep(str(tmp_path), seed=1, workers=1, version="other").run(
+        (400, 4, 15, 2), 3).computed == 3
+    delays = {"delay_model": GeometricDelay(0.5, 15)}
+    assert sweep.run((400, 4, 15, 2, delays), 2).computed == 2
+    assert sweep.run((400, 4, 15, 2, {"delay_model": GeometricDelay(0.6, 15)}), 2).computed == 2
+    assert sweep.run((400, 4, 15, 2, {"delay_model": GeometricDelay(0.5, 15)}), 2).computed == 0
+
+
+def test_cache_files_are_columnar(tmp_path):
+    sweep = Sweep(str(tmp_path), seed=3, workers=1)
+    result = sweep.run((500, 3, 10, 2), 4)
+    (name,) = os.listdir(str(tmp_path))
+    with open(os.path.join(str(tmp_path), name), "rb") as stream:
+        raw = stream.read()
+    magic, count, key_size = CACHE_HEADER.unpack_from(raw)
+    assert magic == CACHE_MAGIC and count == 4
+    columns = raw[CACHE_HEADER.size + key_size:]
+    assert list(struct.unpack("<4q", columns[:32])) == [0, 1, 2, 3]
+    assert list(struct.unpack("<4q", columns[32:])) == result.waste
+    # A damaged file is recomputed, not trusted
+    with open(os.path.join(str(tmp_path), name), "wb") as stream:
+        stream.write(raw[:-8])
+    assert sweep.run((500, 3, 10, 2), 4) == result._replace(computed=4)
+
+
+def test_tolerance_stops_early():
+    sweep = Sweep(seed=9, workers=1)
+    loose = sweep.run(NOISY, 400, tolerance=10.0, min_trials=10)
+    assert len(loose.waste) == 10 and loose.half_width <= 10.0
+    tight = sweep.run(NOISY, 400, tolerance=0.3, min_trials=10)
+    assert 10 < len(tight.waste) < 400 and tight.half_width <= 0.3
+    assert tight.half_width == half_width(tight.waste)
+    assert tight.waste[:10] == loose.waste
+    # Constant waste stops at min_trials
+    steady = sweep.run((400, 4, 15, 3), 400, tolerance=0.01, min_trials=5)
+    assert steady.waste == [60] * 5 and steady.half_width == 0
+
+
+@pytest.mark.needs_native
+def test_backends_share_the_cache(tmp_path):
+    Sweep(str(tmp_path), seed=5, workers=1, backend="python").run(NOISY, 5)
+    shared = Sweep(str(tmp_path), seed=5, workers=1, backend="native").run(NOISY, 8)
+    assert shared.computed == 3
+    assert shared.waste == run_trials(*NOISY[:4], 8, seed=5, workers=1, backend="native",
+                                      **NOISY.options)
+
+
+def test_grid_and_uncacheable_options(tmp_path):
+    cells = list(grid([2000], [3, 4], [15]))
+    assert [(c.m, c.x) for c in cells] == [(3, 1), (3, 2), (3, 3), (4, 1), (4, 2), (4, 3), (4, 4)]
+    assert len(list(grid([100, 200], [4], [5, 10], xs=[2], variants=[{}, {"coalesce": True}]))) == 8
+    with pytest.raises(ValueError):
+        Sweep(seed=1).run((400, 4, 15, 2, {"with_stats": True}), 2)
+    with pytest.raises(ValueError):
+        Sweep(seed=1).run((400, 4, 15, 2, {"profile": object()}), 2)
+    with pytest.raises(TypeError):
+        Sweep(seed=None)
+    assert len(sweep_module.code_version()) == 16
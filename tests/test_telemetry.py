@@ -0,0 +1,58 @@
+import io
+import os
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.ring_sim import run_scenario
+from src.rng import Pcg32
+from src.telemetry import BLOCKED, DATA, EVENT, TelemetryBuffer, iter_events, read_events
+
+
+def test_buffer_flushes_fixed_size_chunks():
+    chunks = []
+    buf = TelemetryBuffer(chunks.append, capacity=3)
+    for tick in range(7):
+        buf.record(tick, 1, DATA, tick + 100, 2)
+    assert [len(chunk) for chunk in chunks] == [3 * EVENT.size, 3 * EVENT.size]
+    buf.flush()
+    assert EVENT.size == 32 and buf.events == 7
+    events = list(iter_events(b"".join(chunks)))
+    assert events[4] == (4, 1, DATA, 104, 2)
+
+
+def test_scenario_events_match_the_run(tmp_path):
+    path = tmp_path / "events.bin"
+    with open(path, "wb") as sink:
+        waste, stats = run_scenario(2000, 4, 15, 2, backend="python", seed=8,
+                                    telemetry=TelemetryBuffer(sink, capacity=64), with_stats=True)
+    events = read_events(path)
+    moves = [event for event in events if event[2] != BLOCKED]
+    assert len(moves) == stats.broadcasts
+    assert sum(1 for event in events if event[2] == DATA) == 2000 - waste - 2
+    assert [event[0] for event in events] == sorted(event[0] for event in events)
+    assert waste == run_scenario(2000, 4, 15, 2, backend="python", seed=8)
+
+
+@pytest.mark.needs_native
+def test_backends_emit_identical_streams():
+    for options in ({}, {"schedule": "batch", "movers": "incremental"}, {"drift": "skip"}):
+        streams = []
+        for backend in ("python", "native"):
+            sink = io.BytesIO()
+            run_scenario(1500, 4, 20, 3, backend=backend, rng=Pcg32(6),
+                         telemetry=TelemetryBuffer(sink, capacity=100), **options)
+            streams.append(sink.getvalue())
+        assert streams[0] == streams[1] and streams[0]
+
+
+@pytest.mark.needs_native
+def test_native_sink_errors_propagate():
+
+    def failing(chunk):
+        raise OSError("disk full")
+
+    with pytest.raises(OSError):
+        run_scenario(1500, 4, 20, 3, backend="native", seed=1,
+                     telemetry=TelemetryBuffer(failing, capacity=16))
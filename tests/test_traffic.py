@@ -0,0 +1,128 @@
+import os
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.ring_sim import run_scenario
+from src.rng import Pcg32
+from src.traffic import (OnOffArrivals, PoissonArrivals, Workload, _MessageTrace,
+                         write_message_trace)
+
+
+def _trace(tmp_path, messages, m):
+    return write_message_trace(os.path.join(str(tmp_path), "messages.trace"), messages, m)
+
+
+def _arrivals(process, ticks, seed=3):
+    rng = Pcg32(seed)
+    process.reset()
+    times = []
+    while not times or times[-1] <= ticks:
+        times.append(process.next_arrival(rng))
+    return times[:-1]
+
+
+def test_poisson_and_on_off_rates():
+    times = _arrivals(PoissonArrivals(0.25), 200_000)
+    assert abs(len(times) / 200_000 - 0.25) < 0.005
+    assert times == sorted(times) and times[0] >= 1
+
+    # On a quarter of the time on average
+    times = _arrivals(OnOffArrivals(1.0, 50, 150), 400_000)
+    assert abs(len(times) / 400_000 - 0.25) < 0.02
+    # Bursty: far more empty stretches of 50 ticks than Poisson at the same mean
+    busy = {t // 50 for t in times}
+    assert len(busy) < 0.5 * 400_000 // 50
+
+
+def test_queues_record_latency_in_arrival_order(tmp_path):
+    path = _trace(tmp_path, [(5, 2), (1, 2), (3, 1), (9, 3)], 3)
+    workload = Workload.from_trace(path, 3, until=6)
+    assert workload.senders == [1, 2, 3]
+    workload.reset(None)
+    busy = []
+    workload.arrive(4, None, busy)
+    assert busy == [2, 1] and workload.arrived == 2
+    workload.arrive(5, None, busy)
+    assert busy == [2, 1] and list(workload.queues[2]) == [1, 5]
+    assert not workload.take(2, 6) and workload.take(2, 8) and workload.take(1, 8)
+    # (9, 3) lies past until
+    assert workload.finished()
+    report = workload.report()
+    assert report["arrived"] == report["sent"] == 3 and report["unsent"] == 0
+    assert report["latency"]["p50"] == 5 and report["latency"]["max"] == 5
+    assert report["latency"]["mean"] == pytest.approx(13 / 3)
+    workload.close()
+
+
+def test_trace_streams_in_chunks(tmp_path):
+    messages = [(t, t % 4 + 1) for t in range(10)]
+    trace = _MessageTrace(_trace(tmp_path, messages, 4), 4, chunk=3)
+    trace.reset()
+    seen = []
+    while trace.peek() is not None:
+        assert len(trace._records) <= 3
+        seen.append(trace.peek())
+        trace.pop()
+    assert seen == messages
+    trace.close()
+    with pytest.raises(ValueError):
+        _MessageTrace(trace.path, 5)
+
+
+def test_senders_spend_one_pad_per_message():
+    workload = Workload([PoissonArrivals(0.1), None, PoissonArrivals(0.05), None], until=20_000)
+    waste, stats = run_scenario(10_000, 4, 10, 2, rng=Pcg32(8), traffic=workload,
+                                with_stats=True)
+    report = workload.report()
+    assert report["arrived"] > 2000 and report["unsent"] == 0
+    assert stats.data_moves == report["sent"]
+    # The pad outlasted the workload, so the low-load latency stays small
+    assert waste == 10_000 - 2 - report["sent"]
+    assert report["latency"]["p999"] < 50
+
+
+def test_saturating_workload_stops_on_the_pad():
+    workload = Workload.poisson(4, 0.5)
+    waste = run_scenario(4000, 4, 10, 4, rng=Pcg32(2), traffic=workload)
+    report = workload.report()
+    assert waste <= 40 and report["unsent"] > 0
+    assert report["latency"]["p50"] <= report["latency"]["p99"] <= report["latency"]["max"]
+
+
+def test_workload_must_match_the_ring():
+    with pytest.raises(ValueError):
+        run_scenario(1000, 4, 5, 3, traffic=Workload.poisson(4, 0.1))
+    with pytest.raises(ValueError):
+        Workload([PoissonArrivals(0.1)] * 2)
+    with pytest.raises(ValueError):
+        OnOffArrivals(0.1, 0, 10)
+
+
+@pytest.mark.parametrize("options", [
+    {},
+    {"movers": "incremental", "coalesce": True, "drift": "skip"},
+    {"schedule": "batch", "event_driven": True, "adaptive": True},
+])
+@pytest.mark.needs_native
+def test_backends_run_the_same_workload(tmp_path, options):
+    path = _trace(tmp_path, [(t * 7 % 3000, t % 5 + 1) for t in range(2500)], 5)
+    workloads = [
+        Workload.poisson(5, 0.2),
+        Workload([OnOffArrivals(0.8, 40, 120), None, PoissonArrivals(0.1), None,
+                  OnOffArrivals(1.0, 5, 5)], until=6000),
+        Workload.from_trace(path, 5),
+    ]
+    for workload in workloads:
+        runs = []
+        for backend in ("python", "native"):
+            rng = Pcg32(6)
+            result = run_scenario(5000, 5, 12, len(workload.senders), backend=backend, rng=rng,
+                                  traffic=workload, with_stats=True, **options)
+            runs.append((result, workload.report(), rng.state))
+        assert runs[0] == runs[1]
+        workload.close()
+    with pytest.raises(ValueError):
+        run_scenario(1000, 5, 5, 5, backend="native", traffic=workloads[0],
+                     checkpoint=str(tmp_path / "run.ckpt"))
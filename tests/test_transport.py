@@ -0,0 +1,142 @@
+import os
+import socket
+import sys
+import time
+from contextlib import contextmanager
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src import transport
+from src.ring_sim import RingParty
+from src.transport import (FIN, FRAME, SharedMemoryTransport, UdpTransport,
+                           measure_latency)
+
+
+@contextmanager
+def shared_ring():
+    writer = SharedMemoryTransport(None, 3, capacity=8, create=True)
+    reader = SharedMemoryTransport(writer.name, 3, capacity=8)
+    try:
+        yield writer, reader
+    finally:
+        reader.close()
+        writer.close()
+        writer.unlink()
+
+
+def test_shared_memory_frames_drive_update_view():
+    with shared_ring() as (writer, reader):
+        party = RingParty(2, 300, 3, 5)
+        writer.send_broadcast(1, 17)
+        writer.send_broadcast(3, 250)
+        assert reader.poll(party) == 2
+        assert party.view_of_others[1] == 17 and party.view_of_others[3] == 250
+        assert reader.poll(party) == 0
+        writer.send_broadcast(1, FIN)
+        reader.poll(party)
+        assert reader.finished == {1} and party.view_of_others[1] == 17
+
+
+def test_shared_memory_reader_skips_overwritten_frames():
+    with shared_ring() as (writer, reader):
+        party = RingParty(2, 300, 3, 5)
+        for index in range(13):
+            writer.send_broadcast(1, index)
+        # The ring holds the last 8 frames; the 5 before them are gone
+        assert reader.poll(party) == 8
+        assert reader.lost == 5
+        assert party.view_of_others[1] == 12
+        assert reader.staleness == list(range(7, -1, -1))
+
+
+class RecordingParty(RingParty):
+    def __init__(self, *args):
+        super().__init__(*args)
+        self.updates = []
+
+    def update_view(self, sender_id, index):
+        self.updates.append((sender_id, index))
+        super().update_view(sender_id, index)
+
+
+def test_shared_memory_reader_keeps_up_across_wraparounds():
+    with shared_ring() as (writer, reader):
+        party = RecordingParty(2, 300, 3, 5)
+        sent = 0
+        for burst in (3, 8, 5, 11, 8, 1):
+            for _ in range(burst):
+                writer.send_broadcast(1, sent)
+                sent += 1
+            reader.poll(party)
+            assert party.view_of_others[1] == sent - 1
+        # Only the burst of 11 overran the 8-frame ring
+        assert reader.lost == 3
+        assert [index for _, index in party.updates] == [i for i in range(sent) if not 16 <= i < 19]
+
+
+def test_shared_memory_reader_discards_frames_torn_by_a_lapping_writer(monkeypatch):
+    with shared_ring() as (writer, reader):
+        party = RecordingParty(2, 300, 3, 5)
+        writer.send_broadcast(1, 0)
+        frame = transport.FRAME
+        laps = []
+
+        class LappedFrame:
+            size = frame.size
+            pack_into = staticmethod(frame.pack_into)
+
+            @staticmethod
+            def unpack_from(buf, offset):
+                old = frame.unpack_from(buf, offset)
+                if not laps:
+                    # The writer laps the ring mid-copy: the reader ends up with
+                    # the old sequence number but the index of the new frame
+                    laps.append(True)
+                    for index in range(1, 9):
+                        writer.send_broadcast(1, 100 + index)
+                    return old[:1] + frame.unpack_from(buf, offset)[1:2] + old[2:]
+                return old
+
+        monkeypatch.setattr(transport, "FRAME", LappedFrame)
+        assert reader.poll(party) == 8
+        assert reader.lost == 1
+        assert party.updates == [(1, 100 + index) for index in range(1, 9)]
+
+
+def test_udp_drops_stale_frames():
+    try:
+        receiver = UdpTransport(2, port=47_177)
+        sender = UdpTransport(2, port=47_177)
+    except OSError as exc:
+        pytest.skip(f"no multicast here: {exc}")
+    party = RingParty(2, 100, 2, 1)
+    try:
+        sender.send_broadcast(1, 5)
+        sender.send_broadcast(1, 6)
+        # A late duplicate of the first frame must not move the view back
+        with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as raw:
+            raw.sendto(FRAME.pack(1, 5, 0, 0), ("239.255.77.77", 47_177))
+        applied = 0
+        for _ in range(200):
+            applied += receiver.poll(party)
+            if receiver.lost:
+                break
+            time.sleep(0.005)
+        if applied == 0:
+            pytest.skip("multicast loopback is not delivered here")
+        assert party.view_of_others[1] == 6
+        assert receiver.lost == 1
+    finally:
+        sender.close()
+        receiver.close()
+
+
+def test_party_processes_finish_over_shared_memory():
+    report = measure_latency(300, 3, 5, moves=50, transport="shm")
+    assert report["moves"] == {1: 50, 2: 50, 3: 50}
+    # Every party reads every move and the FIN of both other parties
+    assert report["frames"] == 3 * 2 * 51
+    assert report["lost"] == 0
+    assert report["latency_us"]["p50"] <= report["latency_us"]["max"]
+    assert report["staleness"]["max"] < 51
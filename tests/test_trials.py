@@ -0,0 +1,48 @@
+import os
+import random
+import statistics
+import sys
+
+import pytest
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from src.ring_sim import run_batch, run_scenario
+from src.trials import run_trials, trial_rng
+
+
+def test_trial_streams_are_distinct_and_stable():
+    draws = [trial_rng(2024, i).getrandbits(64) for i in range(1000)]
+    assert len(set(draws)) == len(draws)
+    assert draws == [trial_rng(2024, i).getrandbits(64) for i in range(1000)]
+    assert trial_rng(2024, 0).getrandbits(64) != trial_rng(2025, 0).getrandbits(64)
+
+
+def test_results_do_not_depend_on_worker_count(backend):
+    serial = run_trials(400, 4, 15, 3, trials=8, seed=5, workers=1, backend=backend)
+    pooled = run_trials(400, 4, 15, 3, trials=8, seed=5, workers=3, backend=backend)
+    assert serial == pooled
+    assert len(serial) == 8
+    assert statistics.mean(serial) == statistics.mean(pooled)
+
+
+def test_options_reach_every_trial():
+    results = run_trials(400, 4, 15, 3, trials=4, seed=1, workers=2, backend="python",
+                         drift="skip", coalesce=True)
+    assert results == [60] * 4
+
+
+def test_run_batch_matches_individual_runs(backend):
+    options = dict(movers="incremental", drift="skip", with_stats=True)
+    batch_rngs = [trial_rng(9, i) for i in range(40)]
+    batch = run_batch(2000, 4, 15, 3, batch_rngs, backend=backend, **options)
+    single_rngs = [trial_rng(9, i) for i in range(40)]
+    single = [run_scenario(2000, 4, 15, 3, backend=backend, rng=rng, **options) for rng in single_rngs]
+    assert batch == single
+    assert [rng.getstate() for rng in batch_rngs] == [rng.getstate() for rng in single_rngs]
+    assert run_batch(2000, 4, 15, 3, [], backend=backend) == []
+
+
+@pytest.mark.needs_native
+def test_native_batch_needs_pcg32():
+    with pytest.raises(TypeError):
+        run_batch(400, 4, 15, 3, [random.Random(1)], backend="native")